@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //Hands 16-bit samples from the thread running the emulator to one audio thread without ever locking.
+    //Neither side waits for the other, samples that don't fit are dropped and counted. Consumers that must get
+    //every sample, like a file, make the emulator wait for room instead
+    class AudioBuffer
+    {
+    public:
+        //A power of two, about three quarters of a second at 44.1 kHz
+        static constexpr std::size_t Capacity = 1 << 15;
+
+        //Only called from the emulation thread, returns the number of samples that fit
+        std::size_t Push(const std::int16_t* samples, std::size_t count)
+        {
+            std::size_t written = 0;
+
+            for (;;)
+            {
+                std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+                std::size_t space = Capacity - (tail - m_Head.load(std::memory_order_acquire));
+                std::size_t chunk = std::min(count - written, space);
+
+                for (std::size_t i = 0; i < chunk; i++)
+                {
+                    m_Samples[(tail + i) & (Capacity - 1)] = samples[written + i];
+                }
+
+                //Publishes the samples to the consumer
+                m_Tail.store(tail + chunk, std::memory_order_release);
+                written += chunk;
+
+                if (written == count || !m_Blocking.load(std::memory_order_acquire))
+                {
+                    break;
+                }
+
+                std::this_thread::yield();
+            }
+
+            m_Dropped.fetch_add(count - written, std::memory_order_relaxed);
+
+            return written;
+        }
+
+        //Makes Push() wait for the consumer to make room instead of dropping samples. Can be called from any thread,
+        //a consumer about to stop turns it off first so a Push() waiting on it goes on
+        void SetBlocking(bool blocking) { m_Blocking.store(blocking, std::memory_order_release); }
+
+        //Only called from the audio thread, returns the number of samples taken
+        std::size_t Pop(std::int16_t* samples, std::size_t count)
+        {
+            std::size_t head = m_Head.load(std::memory_order_relaxed);
+            std::size_t available = m_Tail.load(std::memory_order_acquire) - head;
+            std::size_t read = std::min(count, available);
+
+            for (std::size_t i = 0; i < read; i++)
+            {
+                samples[i] = m_Samples[(head + i) & (Capacity - 1)];
+            }
+
+            //Hands the space back to the producer
+            m_Head.store(head + read, std::memory_order_release);
+
+            return read;
+        }
+
+        //The samples that didn't fit since the buffer was created, the consumer fell behind for that long
+        std::uint64_t GetDropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+    private:
+        std::int16_t m_Samples[Capacity] = { 0 };
+
+        //Each index is written by one side only, on its own cache line so the sides don't slow each other down
+        alignas(64) std::atomic<std::size_t> m_Head{ 0 };
+        alignas(64) std::atomic<std::size_t> m_Tail{ 0 };
+
+        std::atomic<std::uint64_t> m_Dropped{ 0 };
+        std::atomic<bool> m_Blocking{ false };
+    };
+}
@@ -0,0 +1,94 @@
+#include "Audio/AudioGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace CHIP8
+{
+    namespace
+    {
+        //The timers tick at 60 Hz, so a frame is 1/60 of a second
+        constexpr std::uint64_t FrameRate = 60;
+
+        //A quarter of full scale, loud enough without clipping anything mixed with it
+        constexpr std::int16_t Amplitude = 0x2000;
+
+        //The bits of an audio pattern, and its bytes
+        constexpr std::size_t PatternBits = 128;
+        constexpr std::size_t PatternSize = PatternBits / 8;
+    }
+
+    AudioGenerator::AudioGenerator(AudioBuffer& buffer, std::uint32_t sampleRate, std::uint32_t toneFrequency)
+        : m_Buffer(buffer), m_SampleRate(std::max<std::uint32_t>(sampleRate, 1)),
+        m_PhaseStep((std::uint32_t)((std::uint64_t(toneFrequency) << 32) / std::max<std::uint32_t>(sampleRate, 1))),
+        m_Scratch(m_SampleRate / FrameRate + 1)
+    {
+    }
+
+    void AudioGenerator::GenerateFrame(bool sounding)
+    {
+        m_Frames++;
+
+        //Where the frame ends in samples, so the rounding never adds up over many frames
+        std::uint64_t end = m_Frames * m_SampleRate / FrameRate;
+        std::size_t count = (std::size_t)(end - m_Samples);
+
+        m_Samples = end;
+
+        if (sounding)
+        {
+            //The top bit of the phase is the half of the period the wave is in
+            for (std::size_t i = 0; i < count; i++)
+            {
+                m_Scratch[i] = (m_Phase & 0x80000000u) ? -Amplitude : Amplitude;
+                m_Phase += m_PhaseStep;
+            }
+        }
+        else
+        {
+            std::fill(m_Scratch.begin(), m_Scratch.begin() + count, 0);
+            m_Phase = 0;
+        }
+
+        m_Buffer.Push(m_Scratch.data(), count);
+    }
+
+    void AudioGenerator::GenerateFrame(bool sounding, const byte* pattern, byte pitch)
+    {
+        if (std::all_of(pattern, pattern + PatternSize, [](byte bits) { return bits == 0; }))
+        {
+            GenerateFrame(sounding);
+            return;
+        }
+
+        m_Frames++;
+
+        std::uint64_t end = m_Frames * m_SampleRate / FrameRate;
+        std::size_t count = (std::size_t)(end - m_Samples);
+
+        m_Samples = end;
+
+        if (sounding)
+        {
+            //The pattern plays at 4000 * 2^((pitch - 64) / 48) bits per second, the top 7 bits of the phase are the bit
+            double rate = 4000.0 * std::pow(2.0, (pitch - 64) / 48.0);
+            std::uint32_t step = (std::uint32_t)(rate * (double)(1u << 25) / m_SampleRate);
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                std::uint32_t bit = m_Phase >> 25;
+                bool set = (pattern[bit >> 3] >> (7 - (bit & 0x7))) & 0x1;
+
+                m_Scratch[i] = set ? Amplitude : -Amplitude;
+                m_Phase += step;
+            }
+        }
+        else
+        {
+            std::fill(m_Scratch.begin(), m_Scratch.begin() + count, 0);
+            m_Phase = 0;
+        }
+
+        m_Buffer.Push(m_Scratch.data(), count);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Base.h"
+#include "Audio/AudioBuffer.h"
+
+namespace CHIP8
+{
+    //Turns the sound timer into a square wave, a frame of samples at a time.
+    //
+    //Frame N covers the samples from N / 60 to (N + 1) / 60 seconds of emulated time, rounded down, so the samples
+    //stay aligned to emulated time at any sample rate. The wave keeps its phase from frame to frame, so a beep
+    //spanning several frames has no clicks at the frame boundaries
+    class AudioGenerator
+    {
+    public:
+        static constexpr std::uint32_t DefaultSampleRate = 44100;
+        static constexpr std::uint32_t DefaultToneFrequency = 440;
+
+        AudioGenerator(AudioBuffer& buffer, std::uint32_t sampleRate = DefaultSampleRate, std::uint32_t toneFrequency = DefaultToneFrequency);
+
+        //Generates the samples of the next frame, the tone if the sound timer was running during it and silence otherwise
+        void GenerateFrame(bool sounding);
+
+        //Same, but plays the 128 one-bit samples of an XO-CHIP audio pattern at the rate set by its pitch.
+        //A pattern that was never loaded is all zero, which plays the tone instead
+        void GenerateFrame(bool sounding, const byte* pattern, byte pitch);
+
+        std::uint32_t GetSampleRate() const { return m_SampleRate; }
+
+        //The frames and samples generated so far
+        std::uint64_t GetFrames() const { return m_Frames; }
+        std::uint64_t GetSamples() const { return m_Samples; }
+
+    private:
+        AudioBuffer& m_Buffer;
+
+        std::uint32_t m_SampleRate;
+
+        //The position in the wave as a fraction of 2^32, and how far it moves per sample
+        std::uint32_t m_Phase = 0;
+        std::uint32_t m_PhaseStep;
+
+        std::uint64_t m_Frames = 0;
+        std::uint64_t m_Samples = 0;
+
+        //Big enough for a single frame
+        std::vector<std::int16_t> m_Scratch;
+    };
+}
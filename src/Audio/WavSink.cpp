@@ -0,0 +1,134 @@
+#include "Audio/WavSink.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace CHIP8
+{
+    namespace
+    {
+        void Write16(std::ostream& output, std::uint16_t value)
+        {
+            char bytes[2] = { (char)(value & 0xFF), (char)(value >> 8) };
+            output.write(bytes, sizeof(bytes));
+        }
+
+        void Write32(std::ostream& output, std::uint32_t value)
+        {
+            Write16(output, (std::uint16_t)value);
+            Write16(output, (std::uint16_t)(value >> 16));
+        }
+
+        //The size of the RIFF header, the format chunk and the data chunk header
+        constexpr std::uint32_t HeaderSize = 44;
+    }
+
+    WavSink::~WavSink()
+    {
+        Close();
+    }
+
+    bool WavSink::Open(const std::string& path, AudioBuffer& buffer, std::uint32_t sampleRate)
+    {
+        Close();
+
+        m_File.open(path, std::ios::binary | std::ios::trunc);
+
+        if (!m_File)
+        {
+            return false;
+        }
+
+        //The sizes are filled in by Close()
+        WriteHeader(sampleRate, 0);
+
+        m_Buffer = &buffer;
+        m_SampleRate = sampleRate;
+        m_Written.store(0, std::memory_order_relaxed);
+        m_Running.store(true, std::memory_order_relaxed);
+
+        //Every sample goes to the file, the emulator waits for room rather than dropping any
+        buffer.SetBlocking(true);
+
+        m_Thread = std::thread([this]()
+        {
+            while (m_Running.load(std::memory_order_relaxed))
+            {
+                //Nothing to do for a while, a frame of samples is 1/60 of a second
+                if (Drain() == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+        });
+
+        return true;
+    }
+
+    void WavSink::Close()
+    {
+        if (!m_Thread.joinable())
+        {
+            return;
+        }
+
+        //Nothing drains the buffer after this, so the emulator must not wait on it any more
+        m_Buffer->SetBlocking(false);
+
+        m_Running.store(false, std::memory_order_relaxed);
+        m_Thread.join();
+
+        //Whatever the emulator pushed before the thread stopped
+        while (Drain() > 0)
+        {
+        }
+
+        std::uint64_t dataSize = m_Written.load(std::memory_order_relaxed) * 2;
+
+        m_File.seekp(0);
+        WriteHeader(m_SampleRate, (std::uint32_t)std::min<std::uint64_t>(dataSize, UINT32_MAX - HeaderSize));
+        m_File.close();
+    }
+
+    std::size_t WavSink::Drain()
+    {
+        std::int16_t samples[4096];
+        std::size_t total = 0;
+        std::size_t count;
+
+        while ((count = m_Buffer->Pop(samples, sizeof(samples) / sizeof(samples[0]))) > 0)
+        {
+            //WAV is little-endian on every host
+            for (std::size_t i = 0; i < count; i++)
+            {
+                Write16(m_File, (std::uint16_t)samples[i]);
+            }
+
+            total += count;
+        }
+
+        m_Written.fetch_add(total, std::memory_order_relaxed);
+
+        return total;
+    }
+
+    void WavSink::WriteHeader(std::uint32_t sampleRate, std::uint32_t dataSize)
+    {
+        m_File.write("RIFF", 4);
+        Write32(m_File, HeaderSize - 8 + dataSize);
+        m_File.write("WAVE", 4);
+
+        //PCM, mono, 16 bits per sample
+        m_File.write("fmt ", 4);
+        Write32(m_File, 16);
+        Write16(m_File, 1);
+        Write16(m_File, 1);
+        Write32(m_File, sampleRate);
+        Write32(m_File, sampleRate * 2);
+        Write16(m_File, 2);
+        Write16(m_File, 16);
+
+        m_File.write("data", 4);
+        Write32(m_File, dataSize);
+    }
+}
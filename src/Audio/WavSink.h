@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "Base.h"
+#include "Audio/AudioBuffer.h"
+
+namespace CHIP8
+{
+    //Drains an audio buffer on its own thread and streams the samples to a mono 16-bit WAV file.
+    //The buffer is made blocking while the sink is open, so an emulator running ahead of the disk, in turbo
+    //for instance, waits for it instead of leaving gaps in the file.
+    //The sizes in the header are only known at the end, so they're written when the sink is closed
+    class WavSink
+    {
+    public:
+        ~WavSink();
+
+        //Creates the file and starts draining the buffer, returns false if the file can't be created
+        bool Open(const std::string& path, AudioBuffer& buffer, std::uint32_t sampleRate);
+
+        //Drains whatever is left in the buffer, finishes the file and stops the thread
+        void Close();
+
+        std::uint64_t GetSamplesWritten() const { return m_Written.load(std::memory_order_relaxed); }
+
+    private:
+        std::ofstream m_File;
+        AudioBuffer* m_Buffer = nullptr;
+        std::uint32_t m_SampleRate = 0;
+
+        std::thread m_Thread;
+        std::atomic<bool> m_Running{ false };
+        std::atomic<std::uint64_t> m_Written{ 0 };
+
+        //Writes every sample in the buffer, returns the number written
+        std::size_t Drain();
+
+        void WriteHeader(std::uint32_t sampleRate, std::uint32_t dataSize);
+    };
+}
@@ -1,11 +1,20 @@
-#pragma once
-
-#include <cstdint>
-
-namespace CHIP8
-{
-    using byte = std::uint8_t;
-    using sbyte = std::int8_t;
-
-    using word = std::uint16_t;
+#pragma once
+
+#include <cstdint>
+
+//Forces the compiler to inline a function, used for the opcode handlers on the hot path
+#if defined(_MSC_VER)
+    #define CHIP8_FORCE_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+    #define CHIP8_FORCE_INLINE inline __attribute__((always_inline))
+#else
+    #define CHIP8_FORCE_INLINE inline
+#endif
+
+namespace CHIP8
+{
+    using byte = std::uint8_t;
+    using sbyte = std::int8_t;
+
+    using word = std::uint16_t;
 }
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "Batch/BatchRunner.h"
+#include "Batch/WorkStealingPool.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/RomCache.h"
+#include "Emulator/Scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Paths in a manifest are relative to the manifest itself
+        std::string Resolve(const std::string& directory, const std::string& path)
+        {
+            bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+
+            return absolute ? path : directory + path;
+        }
+
+        bool IsNumber(const std::string& text)
+        {
+            return !text.empty() && text.size() <= 19 && text.find_first_not_of("0123456789") == std::string::npos;
+        }
+    }
+
+    bool BatchRunner::LoadManifest(const std::string& path, std::string& error)
+    {
+        std::ifstream manifest(path);
+
+        if (!manifest)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::size_t separator = path.find_last_of("/\\");
+        std::string directory = separator == std::string::npos ? "" : path.substr(0, separator + 1);
+
+        m_Jobs.clear();
+
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(manifest, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string rom;
+
+            //Skip empty lines and comments
+            if (!(tokens >> rom) || rom[0] == '#')
+            {
+                continue;
+            }
+
+            BatchJob job;
+            job.Rom = Resolve(directory, rom);
+
+            std::string setting;
+
+            while (tokens >> setting)
+            {
+                std::size_t equals = setting.find('=');
+                std::string key = setting.substr(0, equals);
+                std::string value = equals == std::string::npos ? "" : setting.substr(equals + 1);
+
+                if (key == "cycles" && IsNumber(value))
+                {
+                    job.Cycles = std::stoull(value);
+                }
+                else if (key == "clock" && IsNumber(value) && value.size() <= 9 && std::stoul(value) > 0)
+                {
+                    job.ClockSpeed = (std::uint32_t)std::stoul(value);
+                }
+                else if (key == "seed" && IsNumber(value))
+                {
+                    job.Seed = (std::uint32_t)std::stoul(value);
+                }
+                else if (key == "quirks")
+                {
+                    if (!ParseQuirkProfile(value.c_str(), job.Quirks))
+                    {
+                        error = path + ":" + std::to_string(lineNumber) + ": unknown quirk profile " + value;
+                        return false;
+                    }
+                }
+                else if (key == "input" && !value.empty())
+                {
+                    job.Input = Resolve(directory, value);
+                }
+                else if (key == "movie" && !value.empty())
+                {
+                    auto movie = std::make_shared<Movie>();
+                    job.Input = Resolve(directory, value);
+
+                    if (!movie->Load(job.Input, error))
+                    {
+                        error = path + ":" + std::to_string(lineNumber) + ": " + error;
+                        return false;
+                    }
+
+                    job.Recording = movie;
+                }
+                else
+                {
+                    error = path + ":" + std::to_string(lineNumber) + ": invalid setting " + setting;
+                    return false;
+                }
+            }
+
+            //The settings of the movie win, only the length can be changed
+            if (job.Recording)
+            {
+                job.Seed = job.Recording->Seed;
+                job.ClockSpeed = job.Recording->ClockSpeed;
+                job.Quirks = job.Recording->Quirks;
+                job.Cycles = job.Cycles == 0 ? job.Recording->Cycles : job.Cycles;
+            }
+
+            if (job.Cycles == 0)
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": missing cycles";
+                return false;
+            }
+
+            m_Jobs.push_back(job);
+        }
+
+        return true;
+    }
+
+    void BatchRunner::Run(std::size_t threadCount, bool pinThreads)
+    {
+        m_Results.assign(m_Jobs.size(), BatchResult());
+        m_Profile.Reset();
+        m_Stacks.Clear();
+
+        WorkStealingPool pool(threadCount, pinThreads);
+
+        //One emulator per thread is all that's ever in use, every job after the first on a thread recycles one
+        EmulatorPool emulators(pool.GetThreadCount());
+
+        //Every job has its own slot in the results, so the threads never write to the same one
+        pool.Run(m_Jobs.size(), [this, &emulators](std::size_t index)
+        {
+            m_Results[index] = RunJob(m_Jobs[index], emulators);
+        });
+    }
+
+    void BatchRunner::WriteResults(std::ostream& output) const
+    {
+        output << "rom,input,seed,cycles,display_hash,wall_ms,error\n";
+
+        for (std::size_t index = 0; index < m_Results.size(); index++)
+        {
+            const BatchJob& job = m_Jobs[index];
+            const BatchResult& result = m_Results[index];
+
+            output << job.Rom << ',' << job.Input << ',' << job.Seed << ',' << result.Cycles << ',';
+
+            if (result.Error.empty())
+            {
+                output << std::hex << std::setw(16) << std::setfill('0') << result.DisplayHash << std::dec << std::setfill(' ');
+            }
+
+            output << ',' << std::fixed << std::setprecision(3) << result.WallTime * 1000.0 << ',' << result.Error << '\n';
+        }
+    }
+
+    BatchResult BatchRunner::RunJob(const BatchJob& job, EmulatorPool& emulators)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        BatchResult result;
+
+        //Jobs running the same ROM share a single mapped image
+        std::shared_ptr<const Rom> rom = RomCache::Global().Load(job.Rom);
+
+        if (!rom)
+        {
+            result.Error = "Could not open " + job.Rom;
+            return result;
+        }
+
+        std::vector<KeyEvent> events;
+
+        if (job.Recording)
+        {
+            //Played with any other ROM, a movie would press keys at the wrong times
+            if (job.Recording->RomHash != rom->GetHash())
+            {
+                result.Error = job.Input + " was recorded with a different ROM";
+                return result;
+            }
+
+            events = job.Recording->Events;
+        }
+        else if (!job.Input.empty() && !LoadInput(job.Input, events, result.Error))
+        {
+            return result;
+        }
+
+        EmulatorPool::Handle emulator = emulators.Acquire(rom);
+        emulator->SetSeed(job.Seed);
+
+        //Pooled emulators keep the profile and the mode of their last job. Switching either drops every compiled block,
+        //so an emulator that last ran the same ROM the same way keeps its code
+        emulator->SetQuirks(job.Quirks);
+
+        if (emulator->GetExecutionMode() != m_Mode)
+        {
+            emulator->SetExecutionMode(m_Mode);
+        }
+
+        //Never paced to the wall clock, so the results only depend on the job
+        Scheduler scheduler(*emulator, job.ClockSpeed);
+
+        //Stacks are rooted at the ROM, so the stacks of different ROMs stay apart
+        StackSampler stacks(m_StackInterval, job.Rom.substr(job.Rom.find_last_of("/\\") + 1));
+
+        if (m_StackInterval > 0)
+        {
+            scheduler.SetStackSampler(&stacks);
+        }
+
+        scheduler.RunScript(events, job.Cycles);
+
+        result.Cycles = scheduler.GetCycles();
+
+        if (ExecutionProfiler::Enabled || m_StackInterval > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_MergeMutex);
+
+            //Recycled emulators start the next job with an empty profile
+            m_Profile.Merge(emulator->GetProfiler());
+            emulator->GetProfiler().Reset();
+
+            m_Stacks.Merge(stacks);
+        }
+
+        std::uint64_t display[Display::MaximumVisibleWords];
+        result.DisplayHash = HashDisplay(display, emulator->GetDisplay().GetVisible(display));
+        result.WallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return result;
+    }
+
+    bool BatchRunner::LoadInput(const std::string& path, std::vector<KeyEvent>& events, std::string& error)
+    {
+        std::ifstream script(path);
+
+        if (!script)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(script, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string first;
+
+            //Skip empty lines and comments
+            if (!(tokens >> first) || first[0] == '#')
+            {
+                continue;
+            }
+
+            KeyEvent event;
+            unsigned int key = 0;
+            std::string state;
+
+            tokens >> std::hex >> key >> state;
+
+            if (!IsNumber(first) || tokens.fail() || key > 0xF || (state != "down" && state != "up"))
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": expected <cycle> <key> <down|up>";
+                return false;
+            }
+
+            event.Cycle = std::stoull(first);
+            event.Key = (byte)key;
+            event.Pressed = state == "down";
+
+            events.push_back(event);
+        }
+
+        //Events at the same instruction keep the order they were written in
+        std::stable_sort(events.begin(), events.end(), [](const KeyEvent& a, const KeyEvent& b)
+        {
+            return a.Cycle < b.Cycle;
+        });
+
+        return true;
+    }
+
+    std::uint64_t BatchRunner::HashDisplay(const std::uint64_t* display, std::size_t rows)
+    {
+        //FNV-1a over the bytes of every row, most significant byte first so the hash doesn't depend on the host
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+
+        for (std::size_t row = 0; row < rows; row++)
+        {
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                hash ^= (display[row] >> shift) & 0xFF;
+                hash *= 0x100000001B3ull;
+            }
+        }
+
+        return hash;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/EmulatorPool.h"
+#include "Emulator/KeypadQueue.h"
+#include "Emulator/Movie.h"
+#include "Emulator/Profiler.h"
+#include "Emulator/Scheduler.h"
+#include "Emulator/StackSampler.h"
+
+namespace CHIP8
+{
+    //A ROM to run headless for a number of instructions, with an optional input script
+    struct BatchJob
+    {
+        std::string Rom;
+
+        //An input script or a movie
+        std::string Input;
+        std::shared_ptr<const Movie> Recording;
+
+        std::uint64_t Cycles = 0;
+        std::uint32_t Seed = 0;
+
+        //Instructions per second of emulated time, the timers tick at 60 Hz of it
+        std::uint32_t ClockSpeed = Scheduler::DefaultClockSpeed;
+
+        QuirkProfile Quirks = QuirkProfile::Modern;
+    };
+
+    struct BatchResult
+    {
+        //Empty if the job ran to the end
+        std::string Error;
+
+        //FNV-1a of the display after the last instruction
+        std::uint64_t DisplayHash = 0;
+        std::uint64_t Cycles = 0;
+
+        //Including loading the ROM and the input script
+        double WallTime = 0.0;
+    };
+
+    //Runs the jobs of a manifest on every core, one emulator per job.
+    //
+    //Every line of a manifest is a ROM followed by its settings, relative paths start at the manifest:
+    //    roms/pong.ch8 cycles=100000 input=inputs/pong.txt seed=7 clock=1000 quirks=vip
+    //A movie brings its own input, seed, clock speed and quirks, and runs as long as it was recorded for unless cycles says otherwise:
+    //    roms/pong.ch8 movie=movies/pong.c8m
+    //Every line of an input script is the instruction count, the key in hexadecimal and whether it goes down or up:
+    //    1200 4 down
+    //Lines starting with # are comments in both.
+    class BatchRunner
+    {
+    public:
+        //Reads the jobs from a manifest, returns false and describes the problem if it can't be used
+        bool LoadManifest(const std::string& path, std::string& error);
+
+        //Runs every job in the given mode, falls back to interpreting without JIT support
+        void SetExecutionMode(ExecutionMode mode) { m_Mode = mode; }
+
+        //Samples the call stack of every job every interval instructions, 0 turns sampling off
+        void SetStackSampling(std::uint64_t interval) { m_StackInterval = interval; }
+
+        //Runs every job, a thread count of 0 uses every hardware thread
+        void Run(std::size_t threadCount = 0, bool pinThreads = false);
+
+        //Writes one line of comma separated values per job, in manifest order
+        void WriteResults(std::ostream& output) const;
+
+        std::size_t GetJobCount() const { return m_Jobs.size(); }
+
+        //The profiles of every job run, added together. Empty unless built with CHIP8_ENABLE_PROFILER
+        const ExecutionProfiler& GetProfile() const { return m_Profile; }
+
+        //The call stacks sampled from every job, the outermost frame is the name of the ROM
+        const StackSampler& GetStacks() const { return m_Stacks; }
+
+    private:
+        std::vector<BatchJob> m_Jobs;
+        std::vector<BatchResult> m_Results;
+
+        ExecutionMode m_Mode = ExecutionMode::Interpreter;
+
+        std::uint64_t m_StackInterval = 0;
+
+        //Guards the profile and the stacks, every job adds its own once it's done
+        std::mutex m_MergeMutex;
+        ExecutionProfiler m_Profile;
+        StackSampler m_Stacks;
+
+        BatchResult RunJob(const BatchJob& job, EmulatorPool& emulators);
+
+        //Reads the key events of an input script, sorted by the instruction they happen at
+        static bool LoadInput(const std::string& path, std::vector<KeyEvent>& events, std::string& error);
+
+        static std::uint64_t HashDisplay(const std::uint64_t* display, std::size_t rows);
+    };
+}
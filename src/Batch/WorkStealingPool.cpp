@@ -0,0 +1,121 @@
+#include "Batch/WorkStealingPool.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace CHIP8
+{
+    WorkStealingPool::WorkStealingPool(std::size_t threadCount, bool pinThreads)
+        : m_ThreadCount(threadCount), m_PinThreads(pinThreads)
+    {
+        //hardware_concurrency() may not know, so there's always at least one thread
+        if (m_ThreadCount == 0)
+        {
+            m_ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        for (std::size_t thread = 0; thread < m_ThreadCount; thread++)
+        {
+            m_Queues.push_back(std::make_unique<Queue>());
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+
+    }
+
+    void WorkStealingPool::Run(std::size_t jobCount, const std::function<void(std::size_t)>& job)
+    {
+        //Deal the jobs out like cards, so every thread starts with a similar mix
+        for (std::size_t index = 0; index < jobCount; index++)
+        {
+            m_Queues[index % m_ThreadCount]->Jobs.push_back(index);
+        }
+
+        //The calling thread only waits, so pinning never changes its affinity
+        std::vector<std::thread> threads;
+
+        for (std::size_t thread = 0; thread < m_ThreadCount; thread++)
+        {
+            threads.emplace_back(&WorkStealingPool::Work, this, thread, std::cref(job));
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void WorkStealingPool::Work(std::size_t thread, const std::function<void(std::size_t)>& job)
+    {
+        if (m_PinThreads)
+        {
+            Pin(thread);
+        }
+
+        std::size_t index;
+
+        while (Take(thread, index))
+        {
+            job(index);
+        }
+    }
+
+    bool WorkStealingPool::Take(std::size_t thread, std::size_t& index)
+    {
+        //Take the most recently dealt job of the thread's own queue
+        {
+            Queue& queue = *m_Queues[thread];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+
+            if (!queue.Jobs.empty())
+            {
+                index = queue.Jobs.back();
+                queue.Jobs.pop_back();
+
+                return true;
+            }
+        }
+
+        //Steal the oldest job of the next thread that still has any, no new jobs arrive so an empty pass means we're done
+        for (std::size_t offset = 1; offset < m_ThreadCount; offset++)
+        {
+            Queue& queue = *m_Queues[(thread + offset) % m_ThreadCount];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+
+            if (!queue.Jobs.empty())
+            {
+                index = queue.Jobs.front();
+                queue.Jobs.pop_front();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkStealingPool::Pin(std::size_t core)
+    {
+    #if defined(_WIN32)
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % (sizeof(DWORD_PTR) * 8)));
+    #elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core % CPU_SETSIZE, &set);
+
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    #else
+        //Affinity isn't supported here, the threads are left to the scheduler
+        (void)core;
+    #endif
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CHIP8
+{
+    //Runs a fixed set of jobs on a group of threads. Every thread starts with its own share of the jobs
+    //and works from the back of its queue, threads that run out steal from the front of the others.
+    class WorkStealingPool
+    {
+    public:
+        //A thread count of 0 uses every hardware thread, pinning binds thread N to core N
+        WorkStealingPool(std::size_t threadCount = 0, bool pinThreads = false);
+        ~WorkStealingPool();
+
+        //Calls the job with every index in [0, jobCount) exactly once, returns when all of them are done
+        void Run(std::size_t jobCount, const std::function<void(std::size_t)>& job);
+
+        std::size_t GetThreadCount() const { return m_ThreadCount; }
+
+    private:
+        struct Queue
+        {
+            std::mutex Mutex;
+            std::deque<std::size_t> Jobs;
+        };
+
+        std::size_t m_ThreadCount;
+        bool m_PinThreads;
+
+        std::vector<std::unique_ptr<Queue>> m_Queues;
+
+        //The loop of a single thread, until there is nothing left to take or steal
+        void Work(std::size_t thread, const std::function<void(std::size_t)>& job);
+
+        //Takes a job from the thread's own queue, or steals one from another queue
+        bool Take(std::size_t thread, std::size_t& index);
+
+        //Binds the calling thread to a single core
+        static void Pin(std::size_t core);
+    };
+}
@@ -0,0 +1,209 @@
+#include "Emulator/BlockCache.h"
+
+#include <cstring>
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Whether or not the instruction is F000 NNNN, which XO-CHIP executes as a single instruction of 4 bytes
+        bool IsLongLoad(const Instruction& instruction)
+        {
+            return instruction.OpCode == 0xF && instruction.X == 0x0 && instruction.NN == 0x00;
+        }
+
+        //Whether or not the instruction can change the program counter, or write to memory
+        bool EndsBlock(const Instruction& instruction)
+        {
+            switch (instruction.OpCode)
+            {
+                //RET, EXIT
+                case 0x0: return instruction.NNN == 0x0EE || instruction.NNN == 0x0FD;
+
+                //JP addr, CALL addr, JP V0, addr
+                case 0x1:
+                case 0x2:
+                case 0xB: return true;
+
+                //SE VX, byte, SNE VX, byte, SE VX, VY, SNE VX, VY
+                case 0x3:
+                case 0x4:
+                case 0x5:
+                case 0x9: return true;
+
+                //SKP VX, SKNP VX
+                case 0xE: return true;
+
+                //LD I, long, LD VX, K, LD B, VX, LD [I], VX
+                case 0xF: return IsLongLoad(instruction) || instruction.NN == 0x0A || instruction.NN == 0x33 || instruction.NN == 0x55;
+
+                default: return false;
+            }
+        }
+
+        //Whether or not the instruction reads the delay timer or the keypad, which is all a program can wait on
+        bool ReadsInput(const Instruction& instruction)
+        {
+            switch (instruction.OpCode)
+            {
+                //SKP VX, SKNP VX
+                case 0xE: return true;
+
+                //LD VX, DT, LD VX, K
+                case 0xF: return instruction.NN == 0x07 || instruction.NN == 0x0A;
+
+                default: return false;
+            }
+        }
+    }
+
+    BlockCache::BlockCache()
+    {
+        //Every block slot knows its own start address, so it can be translated in place
+        for (word address = 0x000; address <= 0xFFF; address++)
+        {
+            m_Blocks[address].Start = address;
+        }
+    }
+
+    Block& BlockCache::Translate(const Memory& memory, word address)
+    {
+        address &= 0xFFF;
+
+        //Start over once the arena cannot hold another block
+        if (m_OperationCount + MaximumBlockLength > OperationArenaSize)
+        {
+            Flush();
+        }
+
+        Block& block = m_Blocks[address];
+        block.Operations = m_OperationCount;
+        block.Length = 0;
+        block.Waits = false;
+        block.Heat = 0;
+        block.Native = nullptr;
+
+        //Decode instructions until one of them ends the block
+        word current = address;
+        Instruction instruction;
+
+        do
+        {
+            //Instructions are two bytes, so combine two successive bytes into one instruction
+            byte hi = memory.Read(current);
+            byte lo = memory.Read((current + 1) & 0xFFF);
+
+            instruction = Decode(((word)hi << 8) | lo);
+            m_Operations[m_OperationCount++] = instruction;
+            block.Length++;
+            block.Waits |= ReadsInput(instruction);
+
+            //Mark both bytes as code so writes to them invalidate this block
+            m_CodeBitmap[current >> 6] |= std::uint64_t(1) << (current & 0x3F);
+            m_CodeBitmap[((current + 1) & 0xFFF) >> 6] |= std::uint64_t(1) << ((current + 1) & 0x3F);
+
+            current += 2;
+        }
+        while (!EndsBlock(instruction) && block.Length < MaximumBlockLength && current <= 0xFFF);
+
+        block.End = current;
+        block.Valid = true;
+
+        //A jump to itself waits for nothing at all, which is how most programs stop. So does EXIT
+        block.Waits |= (instruction.OpCode == 0x1 && instruction.NNN == address) || (instruction.OpCode == 0x0 && instruction.NNN == 0x0FD);
+
+        //Chain the block to its successors when they are known ahead of time
+        switch (instruction.OpCode)
+        {
+            //JP addr always continues at NNN
+            case 0x1:
+            {
+                block.Successors = 1;
+                block.Next[0] = &Lookup(instruction.NNN);
+                break;
+            }
+
+            //Skips continue at either the next or the second next instruction
+            case 0x3:
+            case 0x4:
+            case 0x5:
+            case 0x9:
+            case 0xE:
+            {
+                //XO-CHIP skips F000 NNNN as a whole, which goes past both successors, so such a skip is looked up.
+                //The skipped bytes are marked as code, a write that turns them into F000 retranslates this block
+                word skipped = block.End & 0xFFF;
+                bool skipsLongLoad = memory.Read(skipped) == 0xF0 && memory.Read((skipped + 1) & 0xFFF) == 0x00;
+
+                m_CodeBitmap[skipped >> 6] |= std::uint64_t(1) << (skipped & 0x3F);
+                m_CodeBitmap[((skipped + 1) & 0xFFF) >> 6] |= std::uint64_t(1) << ((skipped + 1) & 0x3F);
+
+                block.Successors = skipsLongLoad ? 0 : 2;
+                block.Next[0] = &Lookup(block.End);
+                block.Next[1] = &Lookup(block.End + 2);
+                break;
+            }
+
+            //RET, EXIT, CALL addr (which doesn't jump on a stack overflow), JP V0, addr and LD VX, K are looked up
+            case 0x0:
+            case 0x2:
+            case 0xB:
+            {
+                block.Successors = 0;
+                break;
+            }
+
+            default:
+            {
+                //LD VX, K might repeat itself and LD I, long might skip its address, everything else falls through
+                //to the next instruction
+                bool waitsForKey = instruction.OpCode == 0xF && instruction.NN == 0x0A;
+
+                block.Successors = !waitsForKey && !IsLongLoad(instruction);
+                block.Next[0] = &Lookup(block.End);
+                break;
+            }
+        }
+
+        return block;
+    }
+
+    void BlockCache::Invalidate(word address)
+    {
+        address &= 0xFFF;
+
+        //Only blocks starting up to a full block length before the address can contain it, or skip over it
+        int first = (int)address - 2 * MaximumBlockLength - 1;
+        first = first < 0 ? 0 : first;
+
+        for (int start = first; start <= address; start++)
+        {
+            Block& block = m_Blocks[start];
+
+            //A skip chained to both successors also depends on the instruction it skips.
+            //Stale code bits are left set, they only cost an extra scan on the next write
+            word end = block.End + (block.Successors == 2 ? 2 : 0);
+            if (block.Valid && address < end)
+            {
+                block.Valid = false;
+            }
+        }
+
+        //An instruction at the last address wraps around to the first one
+        if (address == 0x000)
+        {
+            m_Blocks[0xFFF].Valid = false;
+        }
+    }
+
+    void BlockCache::Flush()
+    {
+        for (Block& block : m_Blocks)
+        {
+            block.Valid = false;
+        }
+
+        m_OperationCount = 0;
+        memset(&m_CodeBitmap[0], 0, sizeof(m_CodeBitmap));
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Base.h"
+#include "Emulator/Instruction.h"
+#include "Emulator/Memory.h"
+#include "Emulator/Registers.h"
+
+namespace CHIP8
+{
+    //Native code translated from a block, called with the emulator, its registers and the pages of its memory
+    using NativeBlock = void (*)(void* context, Registers* registers, const byte* const* memory);
+
+    //A straight run of decoded instructions that ends at a branch, a skip or a store to memory
+    struct Block
+    {
+        //Offset of the first instruction of this block in the operation arena
+        word Operations = 0x0000;
+
+        //The address of the first instruction, and the address after the last instruction
+        word Start = 0x0000;
+        word End = 0x0000;
+
+        //The number of instructions in this block
+        byte Length = 0;
+
+        //Whether or not this block has been translated and can be executed
+        bool Valid = false;
+
+        //The number of successors this block is chained to, 0 means the successor has to be looked up
+        byte Successors = 0;
+
+        //Whether or not this block reads the delay timer or the keypad, or jumps to itself.
+        //Only a loop through such a block can be waiting
+        bool Waits = false;
+
+        //The blocks that can follow this one, indexed by (ProgramCounter - End) / 2
+        Block* Next[2] = { nullptr, nullptr };
+
+        //How many times this block has been interpreted, used to find blocks worth compiling
+        word Heat = 0;
+
+        //The native code compiled from this block, if any
+        NativeBlock Native = nullptr;
+    };
+
+    //Translates and caches blocks of instructions by their start address
+    class BlockCache
+    {
+    public:
+        //The maximum number of instructions in a single block
+        static constexpr byte MaximumBlockLength = 64;
+
+        BlockCache();
+
+        //Returns the block starting at the given address, which might not be translated yet
+        Block& Lookup(word address) { return m_Blocks[address & 0xFFF]; }
+
+        //Returns the first instruction of the given block
+        const Instruction* Operations(const Block& block) const { return &m_Operations[block.Operations]; }
+
+        //Translates the block starting at the given address from memory
+        Block& Translate(const Memory& memory, word address);
+
+        //Whether or not the byte at the given address belongs to a translated block
+        bool IsCode(word address) const { return (m_CodeBitmap[(address & 0xFFF) >> 6] >> (address & 0x3F)) & 0x1; }
+
+        //Invalidates every block containing the byte at the given address
+        void Invalidate(word address);
+
+        //Invalidates every block
+        void Flush();
+
+    private:
+        static constexpr word OperationArenaSize = 0x1000;
+
+        Block m_Blocks[0xFFF + 1];
+
+        Instruction m_Operations[OperationArenaSize];
+        word m_OperationCount = 0;
+
+        //One bit per byte of memory, set if the byte has been translated into a block
+        std::uint64_t m_CodeBitmap[(0xFFF + 1) / 64] = { 0 };
+    };
+}
@@ -0,0 +1,290 @@
+#include "Emulator/Display.h"
+
+#include <cstring>
+
+//Pick the widest vector instructions the compiler is allowed to use
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CHIP8_DISPLAY_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CHIP8_DISPLAY_SSE2
+#endif
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Consecutive rows of a column, shifted with a single instruction
+        struct RowVector
+        {
+        #if defined(CHIP8_DISPLAY_AVX2)
+            static constexpr byte Rows = 4;
+
+            __m256i Value;
+
+            static RowVector Load(const std::uint64_t* rows) { return { _mm256_loadu_si256((const __m256i*)rows) }; }
+            void Store(std::uint64_t* rows) const { _mm256_storeu_si256((__m256i*)rows, Value); }
+
+            template<int Bits> RowVector ShiftLeft() const { return { _mm256_slli_epi64(Value, Bits) }; }
+            template<int Bits> RowVector ShiftRight() const { return { _mm256_srli_epi64(Value, Bits) }; }
+            friend RowVector operator|(RowVector a, RowVector b) { return { _mm256_or_si256(a.Value, b.Value) }; }
+        #elif defined(CHIP8_DISPLAY_SSE2)
+            static constexpr byte Rows = 2;
+
+            __m128i Value;
+
+            static RowVector Load(const std::uint64_t* rows) { return { _mm_loadu_si128((const __m128i*)rows) }; }
+            void Store(std::uint64_t* rows) const { _mm_storeu_si128((__m128i*)rows, Value); }
+
+            template<int Bits> RowVector ShiftLeft() const { return { _mm_slli_epi64(Value, Bits) }; }
+            template<int Bits> RowVector ShiftRight() const { return { _mm_srli_epi64(Value, Bits) }; }
+            friend RowVector operator|(RowVector a, RowVector b) { return { _mm_or_si128(a.Value, b.Value) }; }
+        #else
+            static constexpr byte Rows = 1;
+
+            std::uint64_t Value;
+
+            static RowVector Load(const std::uint64_t* rows) { return { *rows }; }
+            void Store(std::uint64_t* rows) const { *rows = Value; }
+
+            template<int Bits> RowVector ShiftLeft() const { return { Value << Bits }; }
+            template<int Bits> RowVector ShiftRight() const { return { Value >> Bits }; }
+            friend RowVector operator|(RowVector a, RowVector b) { return { a.Value | b.Value }; }
+        #endif
+        };
+
+        //The 4 columns scrolled horizontally
+        constexpr int ScrollBits = 4;
+
+        void ScrollRowsDown(std::uint64_t* column, byte height, byte rows)
+        {
+            rows = rows < height ? rows : height;
+            memmove(column + rows, column, (height - rows) * sizeof(std::uint64_t));
+            memset(column, 0, rows * sizeof(std::uint64_t));
+        }
+
+        void ScrollRowsUp(std::uint64_t* column, byte height, byte rows)
+        {
+            rows = rows < height ? rows : height;
+            memmove(column, column + rows, (height - rows) * sizeof(std::uint64_t));
+            memset(column + height - rows, 0, rows * sizeof(std::uint64_t));
+        }
+    }
+
+    void Display::Reset()
+    {
+        memset(m_Planes, 0, sizeof(m_Planes));
+        m_Selected = 0x1;
+        m_HighResolution = false;
+    }
+
+    void Display::Clear()
+    {
+        //Outside of the current resolution every pixel is already off
+        byte height = GetHeight();
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            if (m_Selected & (1 << plane))
+            {
+                memset(m_Planes[plane].Left, 0, height * sizeof(std::uint64_t));
+                if (m_HighResolution)
+                {
+                    memset(m_Planes[plane].Right, 0, height * sizeof(std::uint64_t));
+                }
+            }
+        }
+    }
+
+    void Display::SetHighResolution(bool highResolution)
+    {
+        memset(m_Planes, 0, sizeof(m_Planes));
+        m_HighResolution = highResolution;
+    }
+
+    void Display::ScrollDown(byte rows)
+    {
+        byte height = GetHeight();
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            if (m_Selected & (1 << plane))
+            {
+                ScrollRowsDown(m_Planes[plane].Left, height, rows);
+                if (m_HighResolution)
+                {
+                    ScrollRowsDown(m_Planes[plane].Right, height, rows);
+                }
+            }
+        }
+    }
+
+    void Display::ScrollUp(byte rows)
+    {
+        byte height = GetHeight();
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            if (m_Selected & (1 << plane))
+            {
+                ScrollRowsUp(m_Planes[plane].Left, height, rows);
+                if (m_HighResolution)
+                {
+                    ScrollRowsUp(m_Planes[plane].Right, height, rows);
+                }
+            }
+        }
+    }
+
+    void Display::ScrollRight()
+    {
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            if (!(m_Selected & (1 << plane)))
+            {
+                continue;
+            }
+
+            std::uint64_t* left = m_Planes[plane].Left;
+            std::uint64_t* right = m_Planes[plane].Right;
+            if (m_HighResolution)
+            {
+                //The pixels leaving the left column move into the right one
+                for (byte row = 0; row < Height; row += RowVector::Rows)
+                {
+                    RowVector l = RowVector::Load(left + row);
+                    RowVector r = RowVector::Load(right + row);
+                    (r.ShiftRight<ScrollBits>() | l.ShiftLeft<64 - ScrollBits>()).Store(right + row);
+                    l.ShiftRight<ScrollBits>().Store(left + row);
+                }
+            }
+            else
+            {
+                for (byte row = 0; row < LowResHeight; row += RowVector::Rows)
+                {
+                    RowVector::Load(left + row).ShiftRight<ScrollBits>().Store(left + row);
+                }
+            }
+        }
+    }
+
+    void Display::ScrollLeft()
+    {
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            if (!(m_Selected & (1 << plane)))
+            {
+                continue;
+            }
+
+            std::uint64_t* left = m_Planes[plane].Left;
+            std::uint64_t* right = m_Planes[plane].Right;
+            if (m_HighResolution)
+            {
+                //The pixels leaving the right column move into the left one
+                for (byte row = 0; row < Height; row += RowVector::Rows)
+                {
+                    RowVector l = RowVector::Load(left + row);
+                    RowVector r = RowVector::Load(right + row);
+                    (l.ShiftLeft<ScrollBits>() | r.ShiftRight<64 - ScrollBits>()).Store(left + row);
+                    r.ShiftLeft<ScrollBits>().Store(right + row);
+                }
+            }
+            else
+            {
+                for (byte row = 0; row < LowResHeight; row += RowVector::Rows)
+                {
+                    RowVector::Load(left + row).ShiftLeft<ScrollBits>().Store(left + row);
+                }
+            }
+        }
+    }
+
+    bool Display::Draw(byte plane, byte x, byte y, const word* sprite, byte rows, bool clip)
+    {
+        Plane& bits = m_Planes[plane];
+        byte height = GetHeight();
+        std::uint64_t collision = 0;
+
+        for (byte i = 0; i < rows; i++)
+        {
+            byte row = y + i;
+            if (row >= height)
+            {
+                if (clip)
+                {
+                    break;
+                }
+
+                row -= height;
+            }
+
+            //The sprite row moved to the leftmost pixels, then shifted to X. The 16 pixels only cross into the next
+            //word, or past the edge, when X is within 16 pixels of its end
+            std::uint64_t line = (std::uint64_t)sprite[i] << 48;
+            if (!m_HighResolution)
+            {
+                std::uint64_t left = line >> x;
+                if (!clip && x > 48)
+                {
+                    left |= line << (64 - x);
+                }
+
+                collision |= bits.Left[row] & left;
+                bits.Left[row] ^= left;
+            }
+            else
+            {
+                std::uint64_t left;
+                std::uint64_t right;
+                if (x < 64)
+                {
+                    left = line >> x;
+                    right = x > 48 ? line << (64 - x) : 0;
+                }
+                else
+                {
+                    left = !clip && x > 112 ? line << (128 - x) : 0;
+                    right = line >> (x - 64);
+                }
+
+                collision |= (bits.Left[row] & left) | (bits.Right[row] & right);
+                bits.Left[row] ^= left;
+                bits.Right[row] ^= right;
+            }
+        }
+
+        return collision != 0;
+    }
+
+    std::size_t Display::GetVisible(std::uint64_t* words) const
+    {
+        byte height = GetHeight();
+        std::size_t count = 0;
+        for (byte plane = 0; plane < PlaneCount; plane++)
+        {
+            const Plane& bits = m_Planes[plane];
+            if (plane > 0)
+            {
+                std::uint64_t any = 0;
+                for (byte row = 0; row < height; row++)
+                {
+                    any |= bits.Left[row] | bits.Right[row];
+                }
+
+                if (any == 0)
+                {
+                    continue;
+                }
+            }
+
+            memcpy(words + count, bits.Left, height * sizeof(std::uint64_t));
+            count += height;
+            if (m_HighResolution)
+            {
+                memcpy(words + count, bits.Right, height * sizeof(std::uint64_t));
+                count += height;
+            }
+        }
+
+        return count;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //The screen of every variant: 64x32 pixels, 128x64 once a SUPER-CHIP program switches to high resolution,
+    //and a second bitplane for XO-CHIP.
+    //
+    //Pixels are one bit each, the leftmost one in the most significant bit. Every plane keeps the left and the right
+    //64 pixels of its rows in two columns of words, so the low resolution screen is the first 32 words of the left
+    //column, the layout a plain CHIP-8 display always had. Scrolling shifts whole columns, several rows per vector
+    //instruction, and a sprite row is drawn with one XOR per word, so the high resolution costs about as much as the low one
+    class Display
+    {
+    public:
+        static constexpr byte Width = 128;
+        static constexpr byte Height = 64;
+        static constexpr byte LowResWidth = 64;
+        static constexpr byte LowResHeight = 32;
+        static constexpr byte PlaneCount = 2;
+
+        //The most words GetVisible() can write
+        static constexpr std::size_t MaximumVisibleWords = PlaneCount * Height * 2;
+
+        struct Plane
+        {
+            std::uint64_t Left[Height];
+            std::uint64_t Right[Height];
+        };
+
+        //Low resolution, only the first plane selected and every pixel off
+        void Reset();
+
+        //Turns off every pixel of the selected planes
+        void Clear();
+
+        //Turns off every pixel of every plane, whether or not the resolution changes
+        void SetHighResolution(bool highResolution);
+        bool IsHighResolution() const { return m_HighResolution; }
+
+        byte GetWidth() const { return m_HighResolution ? Width : LowResWidth; }
+        byte GetHeight() const { return m_HighResolution ? Height : LowResHeight; }
+
+        //The planes that are drawn to, cleared and scrolled, bit N selects plane N
+        void SelectPlanes(byte planes) { m_Selected = planes & 0x3; }
+        byte GetSelectedPlanes() const { return m_Selected; }
+
+        //Scrolls the selected planes by whole rows, or by 4 columns. The pixels moved in are off
+        void ScrollDown(byte rows);
+        void ScrollUp(byte rows);
+        void ScrollRight();
+        void ScrollLeft();
+
+        //XORs a sprite onto a plane, starting on the screen. Every row of the sprite is 16 pixels wide with the leftmost
+        //one in the most significant bit. The pixels past the edges wrap around, or are cut off when clipping.
+        //Returns whether any pixel was turned off
+        bool Draw(byte plane, byte x, byte y, const word* sprite, byte rows, bool clip);
+
+        //Copies the words of the screen out, plane by plane and column by column, and returns how many there are.
+        //Blank planes past the first are left out, so a plain CHIP-8 screen is the same 32 words it always was
+        std::size_t GetVisible(std::uint64_t* words) const;
+
+        const Plane& GetPlane(byte plane) const { return m_Planes[plane]; }
+        Plane& GetPlane(byte plane) { return m_Planes[plane]; }
+
+    private:
+        Plane m_Planes[PlaneCount] = {};
+
+        byte m_Selected = 0x1;
+        bool m_HighResolution = false;
+    };
+}
@@ -1,824 +1,1592 @@
-#include "Emulator/Emulator.h"
-
-#include <random>
-
-/*
- * This program was written by:
- * - Aryan Sinha
- *
- * I made a couple of implementation decisions here primarily for performance reasons. For example, 
- * I avoided branching, as that tends to be slightly slower than not branching. The difference isn't
- * massive, but in high performance applications (such as an emulator like this one), reducing the
- * performance overhead as much as possible allows programs to run at their native speeds on more
- * hardware. Another example is unrolled loops. Unrolled loops tend to be faster, even if the 
- * performance gain is negligible. While these implementations can't always be used, if you can
- * use them, you should try. In some cases, however, the compiler will automatically unroll loops.
- * Some compilers may miss this, however. Doing whatever you can to help the compiler will produce
- * better code and better applications.
- * 
- * I also made sure to comment as much of the code as possible to help when reading this code. If
- * there is anything that is unclear, feel free to experiment with the code in your own fork.
- */
-
-namespace CHIP8
-{
-    Emulator::Emulator()
-    {
-        //Clear the memory
-        memset(&m_Memory[0], 0, 0x1000);
-
-        //Clear the display
-        memset(&m_Display[0], false, 64 * 32);
-
-        //The font used for this emulator
-        static constexpr byte font[] =
-        {
-            0xF0, 0x90, 0x90, 0x90, 0xF0, //0
-            0x20, 0x60, 0x20, 0x20, 0x70, //1
-            0xF0, 0x10, 0xF0, 0x80, 0xF0, //2
-            0xF0, 0x10, 0xF0, 0x10, 0xF0, //3
-            0x90, 0x90, 0xF0, 0x10, 0x10, //4
-            0xF0, 0x80, 0xF0, 0x10, 0xF0, //5
-            0xF0, 0x80, 0xF0, 0x90, 0xF0, //6
-            0xF0, 0x10, 0x20, 0x40, 0x40, //7
-            0xF0, 0x90, 0xF0, 0x90, 0xF0, //8
-            0xF0, 0x90, 0xF0, 0x10, 0xF0, //9
-            0xF0, 0x90, 0xF0, 0x90, 0x90, //A
-            0xE0, 0x90, 0xE0, 0x90, 0xE0, //B
-            0xF0, 0x80, 0x80, 0x80, 0xF0, //C
-            0xE0, 0x90, 0x90, 0x90, 0xE0, //D
-            0xF0, 0x80, 0xF0, 0x80, 0xF0, //E
-            0xF0, 0x80, 0xF0, 0x80, 0x80  //F
-        };
-
-        //Store the font in memory
-        memcpy(&m_Memory[0x000], &font[0x00], 0x50);
-
-        //TODO: Implement loading a ROM from a file
-        
-        //Load the ROM into memory
-        byte rom[0xE00] = { 0 };
-        memcpy(&m_Memory[0x200], &rom[0x000], 0xE00);
-
-        //Register all the opcode functions
-        m_OpCodeFunctions[0x0] = std::bind(&Emulator::OpCode0, this);
-        m_OpCodeFunctions[0x1] = std::bind(&Emulator::OpCode1, this);
-        m_OpCodeFunctions[0x2] = std::bind(&Emulator::OpCode2, this);
-        m_OpCodeFunctions[0x3] = std::bind(&Emulator::OpCode3, this);
-        m_OpCodeFunctions[0x4] = std::bind(&Emulator::OpCode4, this);
-        m_OpCodeFunctions[0x5] = std::bind(&Emulator::OpCode5, this);
-        m_OpCodeFunctions[0x6] = std::bind(&Emulator::OpCode6, this);
-        m_OpCodeFunctions[0x7] = std::bind(&Emulator::OpCode7, this);
-        m_OpCodeFunctions[0x8] = std::bind(&Emulator::OpCode8, this);
-        m_OpCodeFunctions[0x9] = std::bind(&Emulator::OpCode9, this);
-        m_OpCodeFunctions[0xA] = std::bind(&Emulator::OpCodeA, this);
-        m_OpCodeFunctions[0xB] = std::bind(&Emulator::OpCodeB, this);
-        m_OpCodeFunctions[0xC] = std::bind(&Emulator::OpCodeC, this);
-        m_OpCodeFunctions[0xD] = std::bind(&Emulator::OpCodeD, this);
-        m_OpCodeFunctions[0xE] = std::bind(&Emulator::OpCodeE, this);
-        m_OpCodeFunctions[0xF] = std::bind(&Emulator::OpCodeF, this);
-    }
-
-    Emulator::~Emulator()
-    {
-
-    }
-
-    void Emulator::Run()
-    {
-        //Implement clock speed, and delay timers
-        /*
-        Example Fetch/Decode/Execute loop
-
-        //Fetch
-        word instruction = 0x0000;
-            
-        {
-            byte hi = m_Memory[m_ProgramCounter++];
-            byte lo = m_Memory[m_ProgramCounter++];
-
-            instruction = ((word)hi << 8) | lo;
-        }
-
-        //Decode
-        OpCodeFunction func = m_OpCodeFunctions[(instruction >> 24) & 0xF];
-
-        //Execute
-        func();
-        */
-    }
-
-    void Emulator::OpCode0(word instruction)
-    {
-        //Get extra arguments from the instruction
-        word args = instruction & 0xFFF;
-
-        switch (args)
-        {
-            //CLS
-            case 0x0E0:
-            {
-                //Reset all the bits of the display
-                memset(&m_Display, 0, 64 * 32);
-                break;
-            }
-
-            //RET
-            case 0x0EE:
-            {
-                //Make sure the interpreter is currently in a subroutine
-                if (m_Registers.StackPointer < 0)
-                {
-                    //TODO: Implement some kind of stack underflow error
-                    break;
-                }
-
-                //Set the program counter to the address at the top of the stack
-                m_Registers.ProgramCounter = m_Registers.Stack[m_Registers.StackPointer];
-
-                //Subtract one from the stack pointer
-                m_Registers.StackPointer--;
-
-                break;
-            }
-
-            //SYS addr
-            default:
-            {
-                //This instruction is ignored by most modern interpreters
-
-                break;
-            }
-        }
-    }
-
-    void Emulator::OpCode1(word instruction)
-    {
-        //JP addr
-        {
-            //Get the address
-            word args = instruction & 0xFFF;
-
-            //Set the program counter to NNN
-            m_Registers.ProgramCounter = args;
-        }
-    }
-
-    void Emulator::OpCode2(word instruction)
-    {
-        //CALL addr
-        {
-            //Check to see if there is space left in the stack
-            if (m_Registers.StackPointer >= MaximumStackCount)
-            {
-                //TODO: Implement some kind of stack overflow error
-                return;
-            }
-
-            //Get the address
-            word args = instruction & 0xFFF;
-
-            //Increment the stack pointer
-            m_Registers.StackPointer++;
-
-            //Put the current program counter on the top of the stack
-            m_Registers.Stack[m_Registers.StackPointer] = m_Registers.ProgramCounter;
-
-            //Set the program counter to the address
-            m_Registers.ProgramCounter = args;
-        }
-    }
-
-    void Emulator::OpCode3(word instruction)
-    {
-        //SE VX, byte
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte nn = args & 0xFF;
-
-            //Get the value in VX
-            byte vx = m_Registers.Variable[x];
-
-            //Compare register VX to NN
-            bool comparison = vx == nn;
-
-            //If they are equal, increment the program counter by 2
-            m_Registers.ProgramCounter += comparison * 2;
-        }
-    }
-
-    void Emulator::OpCode4(word instruction)
-    {
-        //SNE VX, byte
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte nn = args & 0xFF;
-
-            //Get the value in VX
-            byte vx = m_Registers.Variable[x];
-
-            //Compare register VX to NN
-            bool comparison = vx != nn;
-
-            //If they are equal, increment the program counter by 2
-            m_Registers.ProgramCounter += comparison * 2;
-        }
-    }
-
-    void Emulator::OpCode5(word instruction)
-    {
-        //SE VX, VY
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte y = (args >> 4) & 0xF;
-
-            //Get the values of VX and VY
-            byte vx = m_Registers.Variable[x];
-            byte vy = m_Registers.Variable[y];
-
-            //Compare register VX to register VY
-            bool comparison = vx == vy;
-
-            //If they are equal, increment the program counter by 2
-            m_Registers.ProgramCounter += comparison * 2;
-        }
-    }
-
-    void Emulator::OpCode6(word instruction)
-    {
-        //LD VX, byte
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte nn = args & 0xFF;
-
-            //Put the value of NN into register VX
-            m_Registers.Variable[x] = nn;
-        }
-    }
-
-    void Emulator::OpCode7(word instruction)
-    {
-        //ADD VX, byte
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte nn = args & 0xFF;
-
-            //Get the value of VX
-            byte vx = m_Registers.Variable[x];
-
-            //Add the value NN to the value of register VX and store the value of VX
-            m_Registers.Variable[x] = vx + nn;
-        }
-    }
-
-    void Emulator::OpCode8(word instruction)
-    {
-        //Get extra arguments from the instruction
-        word args = instruction & 0xFFF;
-        byte x = (args >> 8) & 0xF;
-        byte y = (args >> 4) & 0xF;
-
-        //Get the values of VX and VY
-        byte vx = m_Registers.Variable[x];
-        byte vy = m_Registers.Variable[y];
-
-        //Get the specific instruction
-        byte specificInstruction = args & 0xF;
-
-        switch (specificInstruction)
-        {
-            //LD VX, VY
-            case 0x0:
-            {
-                //Store the value of VY into register VX
-                m_Registers.Variable[x] = vy;
-
-                break;
-            }
-
-            //OR VX, VY
-            case 0x1:
-            {
-                //Perform a bitwise OR on the values in VX and VY, then store the value in VX
-                m_Registers.Variable[x] = vx | vy;
-
-                break;
-            }
-
-            //AND VX, VY
-            case 0x2:
-            {
-                //Perform a bitwise AND on the values in VX and VY, then store the value in VX
-                m_Registers.Variable[x] = vx & vy;
-
-                break;
-            }
-
-            //XOR VX, VY
-            case 0x3:
-            {
-                //Perform a bitwise XOR on the values in VX and VY, then store the value in VX
-                m_Registers.Variable[x] = vx ^ vy;
-
-                break;
-            }
-
-            //ADD VX, VY
-            case 0x4:
-            {
-                //Add the values of VX and VY together
-                word result = vx + vy;
-
-                //If the result is greater than 8 bits, set VF to 1, otherwise 0
-                bool carry = (result >> 8) & 0xFF;
-                m_Registers.Variable[0xF] = carry;
-
-                //Store the lower 8 bits into VX
-                m_Registers.Variable[x] = result & 0xFF;
-
-                break;
-            }
-
-            //SUB VX, VY
-            case 0x5:
-            {
-                //If VX is greater than VY, set VF to 1, otherwise 0
-                bool nBorrow = vx > vy;
-                m_Registers.Variable[0xF] = nBorrow;
-
-                //Subtract VY from VX and store it in VX
-                m_Registers.Variable[x] = vx - vy;
-
-                break;
-            }
-
-            //SHR VX {, VY}
-            case 0x6:
-            {
-                //Get the least significant bit and store it in VF
-                m_Registers.Variable[0xF] = vx & 0x01;
-
-                //Divide VX by 2
-                m_Registers.Variable[x] = vx / 2;
-
-                break;
-            }
-
-            //SUBN VX, VY
-            case 0x7:
-            {
-                //If VY is greater than VX, set VF to 1, otherwise 0
-                bool nBorrow = vy > vx;
-                m_Registers.Variable[0xF] = nBorrow;
-
-                //Subtract VX from VY and store it in VX
-                m_Registers.Variable[x] = vy - vx;
-
-                break;
-            }
-
-            //SHL VX {, VY}
-            case 0xE:
-            {
-                //Get the most significant bit and store it in VF
-                m_Registers.Variable[0xF] = (vx >> 7) & 0x01;
-
-                //Multiply VX by 2
-                m_Registers.Variable[x] = vx * 2;
-
-                break;
-            }
-
-            //No known opcodes
-            default
-            {
-                break;
-            }
-        }
-    }
-
-    void Emulator::OpCode9(word instruction)
-    {
-        //SNE VX, VY
-        {
-            //Get extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte y = (args >> 4) & 0xF;
-
-            //Get the values in VX and VY
-            byte vx = m_Registers.Variable[x];
-            byte vy = m_Registers.Variable[y];
-
-            //Compare the variables of VX and VY
-            bool comparison = vx != vy;
-
-            //If they are not equal, increment the program counter by 2
-            m_Registers.ProgramCounter += comparison * 2;
-        }
-    }
-
-    void Emulator::OpCodeA(word instruction)
-    {
-        //LD I, addr
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-
-            //Set the value of register I to NNN
-            m_Registers.Index = args;
-        }
-    }
-
-    void Emulator::OpCodeB(word instruction)
-    {
-        //JP V0, addr
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-
-            //Get the value in V0
-            byte v0 = m_Registers.Variable[0x0];
-
-            //Set the program counter to V0 + NNN
-            m_Registers.ProgramCounter = v0 + args;
-        }
-    }
-
-    void Emulator::OpCodeC(word instruction)
-    {
-        //RND VX, byte
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) 0xF;
-            word nn = args & 0xFF;
-
-            //The random number generator used
-            static std::indepdenent_bits_engine<std::default_random_engine, sizeof(byte) * 8, byte> RNG;
-
-            //The random number generator
-            byte result = RNG();
-
-            //Store the result bitwise ANDed with NN and store it in VX
-            m_Registers.Variable[x] = result & nn;
-        }
-    }
-
-    void Emulator::OpCodeD(word instruction)
-    {
-        //DRAW VX, VY, nibble
-        {
-            //Get the extra arguments from the instruction
-            word args = instruction & 0xFFF;
-            byte x = (args >> 8) & 0xF;
-            byte y = (args >> 4) & 0xF;
-            byte n = args & 0xF;
-
-            //Get the values in VX and VY
-            byte vx = m_Registers.Variable[x];
-            byte vy = m_Registers.Variable[y];
-
-            //Reset VF
-            m_Registers.Variable[0xF] = 0x00;
-
-            //Draw each sprite line by line
-            for (byte i = 0; i < n; i++)
-            {
-                //Get the current line of this sprite
-                byte currentLine = m_Memory[m_Registers.Index];
-
-                //Draw this line pixel by pixel
-                bool currentPixel = false;
-                byte coordinate = 0;
-                bool collision = false;
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 7) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 0) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 6) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 1) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 5) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 2) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 4) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 3) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 3) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 4) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 2) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 5) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = (currentLine >> 1) & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 6) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                {
-                    //Determine whether or not to flip the current pixel
-                    currentPixel = currentLine & 0x01;
-
-                    //The screen coordinate to look at
-                    coordinate = (vx + 7) + (vy + 32 * i);
-
-                    //Make sure this coordinate is actually on screen
-                    coordinate %= 64 * 32;
-
-                    //Check if there will be a collision
-                    collision |= m_Display[coordinate] && currentPixel;
-
-                    //Flip this screen coordinate
-                    m_Display[coordinate] = m_Display[coordinate] != currentPixel;
-                }
-
-                m_Registers.Variable[0xF] = collision;
-            }
-        }
-    }
-
-    void Emulator::OpCodeE(word instruction)
-    {
-        //Get extra arguments from the instruction
-        word args = instruction & 0xFFF;
-        byte x = (args >> 8) & 0xF;
-
-        //Get the value of VX
-        byte vx = m_Registers.Variable[x];
-
-        //Get the specific instruction
-        byte specificInstruction = args & 0xFF;
-
-        switch (specificInstruction)
-        {
-            //SKP VX
-            case 0x9E:
-            {
-                //Check the current state of the key
-                //TODO: Implement keypad
-                bool keyPressed = false;
-
-                //If the key is pressed, increment the program counter by 2
-                m_Registers.ProgramCounter += keyPressed * 2;
-
-                break;
-            }
-
-            //SKNP VX
-            case 0xA1:
-            {
-                //Check the current state of the key
-                //TODO: Implement keypad
-                bool keyPressed = false;
-
-                //If the key is not pressed, increment the program counter by 2
-                m_Registers.ProgramCounter += keyPressed * 2;
-
-                break;
-            }
-
-            //No known opcodes
-            default
-            {
-                break;
-            }
-        }
-    }
-
-    void Emulator::OpCodeF(word instruction)
-    {
-        //Get extra arguments from the instruction
-        word args = instruction & 0xFFF;
-        byte x = (args >> 8) & 0xF;
-
-        //Get the value of VX
-        byte vx = m_Registers.Variable[x];
-
-        //Get the specific instruction
-        byte specificInstruction = args & 0xFF;
-
-        switch (specificInstruction)
-        {
-            //LD VX, DT
-            case 0x07:
-            {
-                //Place the value of the delay timer into VX
-                m_Registers.Variable[x] = m_Registers.DelayTimer;
-
-                break;
-            }
-
-            //LD VX, K
-            case 0x0A:
-            {
-                //Get the currently pressed key
-                //TODO: Implement keypad
-                sbyte pressedKey = 0;
-                bool keyPressed = pressedKey >= 0x0;
-
-                //If there is a pressed key, store the pressed key in VX
-                m_Registers.Variable[x] = keyPressed * pressedKey;
-
-                //Halt execution otherwise
-                m_Registers.ProgramCounter -= (!keyPressed) * 2;
-
-                break;
-            }
-
-            //LD DT, VX
-            case 0x15:
-            {
-                //Set the delay timer to the value in VX
-                m_Registers.DelayTimer = vx;
-
-                break;
-            }
-
-            //LD ST, VX
-            case 0x18:
-            {
-                //Set the sound timer to the value in VX
-                m_Registers.SoundTimer = vx;
-
-                break;
-            }
-
-            //ADD I, VX
-            case 0x1E:
-            {
-                //Set the value of the index register to the sum of itself and VX
-                m_Registers.Index = m_Registers.Index + vx;
-
-                break;
-            }
-
-            //LD F, VX
-            case 0x29:
-            {
-                //Set the index register to the location for the hexadecimal sprite corresponding to VX
-                m_Registers.Index = 5 * vx;
-
-                break;
-            }
-
-            //LD B, VX
-            case 0x33:
-            {
-                //Store the ones digit of vx in index + 2
-                m_Memory[m_Registers.Index + 2] = vx % 10;
-
-                //Store the tens digit of vx in index + 1
-                vx /= 10;
-                m_Memory[m_Registers.Index + 1] = vx % 10;
-
-                //Store the hundreds digit of vx in index
-                vx /= 10;
-                m_Memory[m_Registers.Index + 0] = vx % 10;
-
-                break;
-            }
-
-            //LD [I], VX
-            case 0x55:
-            {
-                //Go through all the values between 0 and x (inclusive)
-                for (byte i = 0; i <= x; i++)
-                {
-                    //Get the value of the current variable register
-                    byte vi = m_Registers.Variable[i];
-
-                    //Store the value of VI in memory at index + i
-                    m_Memory[m_Registers.Index + i] = vi;
-                }
-
-                break;
-            }
-
-            //LD VX, [I]
-            case 0x65:
-            {
-                //Go through all the values between 0 and x (inclusive)
-                for (byte i = 0; i <= x; i++)
-                {
-                    //Store the value at memory location index + i in vi
-                    m_Registers.Variable[i] = m_Memory[m_Registers.Index + i];
-                }
-
-                break;
-            }
-
-            //No known opcodes
-            default
-            {
-                break;
-            }
-        }
-    }
+#include "Emulator/Emulator.h"
+#include "Emulator/Font.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+/*
+ * This program was written by:
+ * - Aryan Sinha
+ *
+ * I made a couple of implementation decisions here primarily for performance reasons. For example, 
+ * I avoided branching, as that tends to be slightly slower than not branching. The difference isn't
+ * massive, but in high performance applications (such as an emulator like this one), reducing the
+ * performance overhead as much as possible allows programs to run at their native speeds on more
+ * hardware. Another example is unrolled loops. Unrolled loops tend to be faster, even if the 
+ * performance gain is negligible. While these implementations can't always be used, if you can
+ * use them, you should try. In some cases, however, the compiler will automatically unroll loops.
+ * Some compilers may miss this, however. Doing whatever you can to help the compiler will produce
+ * better code and better applications.
+ * 
+ * I also made sure to comment as much of the code as possible to help when reading this code. If
+ * there is anything that is unclear, feel free to experiment with the code in your own fork.
+ */
+
+namespace CHIP8
+{
+    namespace
+    {
+        constexpr byte StateMagic[4] = { 'C', '8', 'S', 'T' };
+
+        //Writes a saved state, least significant byte first
+        class StateWriter
+        {
+        public:
+            StateWriter(byte* data)
+                : m_Data(data)
+            {
+            }
+
+            void Write(const byte* data, std::size_t size)
+            {
+                memcpy(m_Data, data, size);
+                m_Data += size;
+            }
+
+            void Write8(byte value) { *m_Data++ = value; }
+            void Write16(word value) { Write8((byte)value); Write8((byte)(value >> 8)); }
+            void Write32(std::uint32_t value) { Write16((word)value); Write16((word)(value >> 16)); }
+            void Write64(std::uint64_t value) { Write32((std::uint32_t)value); Write32((std::uint32_t)(value >> 32)); }
+
+        private:
+            byte* m_Data;
+        };
+
+        //Reads a saved state, least significant byte first
+        class StateReader
+        {
+        public:
+            StateReader(const byte* data)
+                : m_Data(data)
+            {
+            }
+
+            //Returns the skipped bytes
+            const byte* Skip(std::size_t size)
+            {
+                const byte* data = m_Data;
+                m_Data += size;
+
+                return data;
+            }
+
+            byte Read8() { return *m_Data++; }
+            word Read16() { word low = Read8(); return low | (word)(Read8() << 8); }
+            std::uint32_t Read32() { std::uint32_t low = Read16(); return low | ((std::uint32_t)Read16() << 16); }
+            std::uint64_t Read64() { std::uint64_t low = Read32(); return low | ((std::uint64_t)Read32() << 32); }
+
+        private:
+            const byte* m_Data;
+        };
+    }
+
+    Emulator::Emulator(std::shared_ptr<const Rom> rom)
+        : m_BlockCache(std::make_unique<BlockCache>()), m_Rom(std::move(rom))
+    {
+        //Copy the font and the ROM into memory, the display starts out cleared
+        m_Memory.Load(GetImage().Memory);
+    }
+
+    Emulator::~Emulator()
+    {
+
+    }
+
+    void Emulator::LoadProgram(const byte* program, std::size_t size)
+    {
+        LoadRom(Rom::Copy(program, size));
+    }
+
+    void Emulator::LoadRom(std::shared_ptr<const Rom> rom)
+    {
+        //The same ROM again, so everything decoded from it can be kept
+        if (rom == m_Rom)
+        {
+            Reset();
+            return;
+        }
+
+        m_Rom = std::move(rom);
+
+        m_Memory.Load(GetImage().Memory);
+
+        //Every decoded instruction and translated block could have come from the old program
+        for (Instruction& instruction : m_DecodedInstructions)
+        {
+            instruction.Valid = false;
+        }
+
+        m_BlockCache->Flush();
+
+        ResetMachine();
+    }
+
+    void Emulator::Reset()
+    {
+        RestoreMemory(&GetImage().Memory[0]);
+        ResetMachine();
+    }
+
+    void Emulator::RestoreMemory(const byte* memory)
+    {
+        //Usually only a few bytes were written since the memory was saved. Restoring just those keeps
+        //every instruction decoded, translated or compiled from the rest of memory
+        for (std::size_t page = 0; page < Memory::PageCount; page++)
+        {
+            const byte* current = m_Memory.GetPage((byte)page);
+            const byte* restored = &memory[page * Memory::PageSize];
+
+            if (memcmp(current, restored, Memory::PageSize) == 0)
+            {
+                continue;
+            }
+
+            for (word offset = 0; offset < Memory::PageSize; offset++)
+            {
+                if (current[offset] != restored[offset])
+                {
+                    //Writing might give this emulator its own copy of the page, so it's looked up again
+                    WriteMemory((word)(page * Memory::PageSize + offset), restored[offset]);
+                    current = m_Memory.GetPage((byte)page);
+                }
+            }
+        }
+    }
+
+    void Emulator::ForkFrom(const Emulator& parent)
+    {
+        if (&parent == this)
+        {
+            return;
+        }
+
+        if (m_StaticProgram != parent.m_StaticProgram)
+        {
+            SetStaticProgram(parent.m_StaticProgram);
+        }
+
+        SetQuirks(parent.m_Quirks);
+
+        //Only the bytes that differ from the parent invalidate anything, so forking from the same machine
+        //again keeps everything decoded, translated or compiled before. Only the first 4 KB can hold code
+        for (byte page = 0; page < Memory::CodePageCount; page++)
+        {
+            if (m_Memory.Shares(parent.m_Memory, page))
+            {
+                continue;
+            }
+
+            const byte* current = m_Memory.GetPage(page);
+            const byte* forked = parent.m_Memory.GetPage(page);
+
+            for (word offset = 0; offset < Memory::PageSize; offset++)
+            {
+                if (current[offset] != forked[offset])
+                {
+                    InvalidateMemory(page * Memory::PageSize + offset);
+                }
+            }
+        }
+
+        //Every page is shared until one of the two machines writes to it
+        m_Memory = parent.m_Memory;
+        m_Rom = parent.m_Rom;
+
+        m_Display = parent.m_Display;
+
+        m_Registers = parent.m_Registers;
+        m_Keys = parent.m_Keys;
+        m_Random = parent.m_Random;
+        m_IdleLoop.Length = 0;
+    }
+
+    std::unique_ptr<Emulator> Emulator::Fork() const
+    {
+        std::unique_ptr<Emulator> child = std::make_unique<Emulator>(m_Rom);
+        child->SetExecutionMode(GetExecutionMode());
+        child->ForkFrom(*this);
+
+        return child;
+    }
+
+    void Emulator::ResetMachine()
+    {
+        m_Display.Reset();
+
+        m_Registers = Registers();
+        m_Keys = 0;
+        m_IdleLoop.Length = 0;
+    }
+
+    const MemoryImage& Emulator::GetImage() const
+    {
+        return m_Rom ? m_Rom->GetImage() : InitialImage;
+    }
+
+    void Emulator::SaveState(byte* state) const
+    {
+        StateWriter writer(state);
+
+        writer.Write(StateMagic, sizeof(StateMagic));
+        writer.Write16(StateVersion);
+
+        for (std::size_t page = 0; page < Memory::PageCount; page++)
+        {
+            writer.Write(m_Memory.GetPage((byte)page), Memory::PageSize);
+        }
+
+        for (byte plane = 0; plane < Display::PlaneCount; plane++)
+        {
+            for (std::uint64_t row : m_Display.GetPlane(plane).Left)
+            {
+                writer.Write64(row);
+            }
+
+            for (std::uint64_t row : m_Display.GetPlane(plane).Right)
+            {
+                writer.Write64(row);
+            }
+        }
+
+        writer.Write8(m_Display.IsHighResolution());
+        writer.Write8(m_Display.GetSelectedPlanes());
+
+        writer.Write16(m_Registers.ProgramCounter);
+        writer.Write16(m_Registers.Index);
+
+        for (word address : m_Registers.Stack)
+        {
+            writer.Write16(address);
+        }
+
+        writer.Write8((byte)m_Registers.StackPointer);
+        writer.Write8(m_Registers.DelayTimer);
+        writer.Write8(m_Registers.SoundTimer);
+        writer.Write(m_Registers.Variable, sizeof(m_Registers.Variable));
+        writer.Write(m_Registers.Flags, sizeof(m_Registers.Flags));
+        writer.Write(m_Registers.Pattern, sizeof(m_Registers.Pattern));
+        writer.Write8(m_Registers.Pitch);
+
+        writer.Write32(m_Random.State);
+    }
+
+    std::vector<byte> Emulator::SaveState() const
+    {
+        std::vector<byte> state(StateSize);
+        SaveState(state.data());
+
+        return state;
+    }
+
+    bool Emulator::LoadState(const byte* state, std::size_t size)
+    {
+        StateReader reader(state);
+
+        //Check everything before changing anything
+        if (size != StateSize || memcmp(state, StateMagic, sizeof(StateMagic)) != 0)
+        {
+            return false;
+        }
+
+        reader.Skip(sizeof(StateMagic));
+
+        if (reader.Read16() != StateVersion)
+        {
+            return false;
+        }
+
+        //RET and CALL index the stack with the stack pointer, one outside of it would reach past the registers
+        constexpr std::size_t StackPointerOffset = sizeof(StateMagic) + 2 + Memory::Size + Display::PlaneCount * Display::Height * 2 * 8 +
+            1 + 1 + 2 + 2 + MaximumStackCount * 2;
+        sbyte stackPointer = (sbyte)state[StackPointerOffset];
+
+        if (stackPointer < -1 || stackPointer >= MaximumStackCount)
+        {
+            return false;
+        }
+
+        RestoreMemory(reader.Skip(Memory::Size));
+
+        //The planes are read before the mode, which would clear them
+        const byte* planes = reader.Skip(Display::PlaneCount * Display::Height * 2 * 8);
+        m_Display.SetHighResolution(reader.Read8() != 0);
+        m_Display.SelectPlanes(reader.Read8());
+
+        StateReader planeReader(planes);
+        for (byte plane = 0; plane < Display::PlaneCount; plane++)
+        {
+            for (std::uint64_t& row : m_Display.GetPlane(plane).Left)
+            {
+                row = planeReader.Read64();
+            }
+
+            for (std::uint64_t& row : m_Display.GetPlane(plane).Right)
+            {
+                row = planeReader.Read64();
+            }
+        }
+
+        m_Registers.ProgramCounter = reader.Read16();
+        m_Registers.Index = reader.Read16();
+
+        for (word& address : m_Registers.Stack)
+        {
+            address = reader.Read16();
+        }
+
+        m_Registers.StackPointer = (sbyte)reader.Read8();
+        m_Registers.DelayTimer = reader.Read8();
+        m_Registers.SoundTimer = reader.Read8();
+        memcpy(m_Registers.Variable, reader.Skip(sizeof(m_Registers.Variable)), sizeof(m_Registers.Variable));
+        memcpy(m_Registers.Flags, reader.Skip(sizeof(m_Registers.Flags)), sizeof(m_Registers.Flags));
+        memcpy(m_Registers.Pattern, reader.Skip(sizeof(m_Registers.Pattern)), sizeof(m_Registers.Pattern));
+        m_Registers.Pitch = reader.Read8();
+
+        m_Random.State = reader.Read32();
+        m_IdleLoop.Length = 0;
+
+        return true;
+    }
+
+    void Emulator::TickTimers()
+    {
+        //Both timers stop at zero
+        m_Registers.DelayTimer -= m_Registers.DelayTimer > 0;
+        m_Registers.SoundTimer -= m_Registers.SoundTimer > 0;
+    }
+
+    void Emulator::SetExecutionMode(ExecutionMode mode)
+    {
+        //Blocks might still point at native code, so they all have to be retranslated
+        m_BlockCache->Flush();
+        m_JitCache.reset();
+
+        if (mode == ExecutionMode::Jit && JitCache::IsSupported() && !ExecutionProfiler::Enabled)
+        {
+            //Compiled code falls back to the handlers of the same profile
+            JitFallback fallback;
+
+            switch (m_Quirks)
+            {
+                case QuirkProfile::CosmacVip: fallback = &Emulator::Interpret<CosmacVipQuirks>; break;
+                case QuirkProfile::SuperChip: fallback = &Emulator::Interpret<SuperChipQuirks>; break;
+                case QuirkProfile::XoChip: fallback = &Emulator::Interpret<XoChipQuirks>; break;
+                default: fallback = &Emulator::Interpret<ModernQuirks>; break;
+            }
+
+            m_JitCache = std::make_unique<JitCache>(fallback, QuirkFlags::Of(m_Quirks));
+        }
+    }
+
+    void Emulator::SetQuirks(QuirkProfile profile)
+    {
+        if (profile == m_Quirks)
+        {
+            return;
+        }
+
+        //Decoding doesn't depend on the profile, but blocks compiled for the old one do
+        m_Quirks = profile;
+        SetExecutionMode(GetExecutionMode());
+    }
+
+    CHIP8_FORCE_INLINE const Instruction& Emulator::Fetch()
+    {
+        //Only 12 bits of the program counter can be used to address memory
+        word address = m_Registers.ProgramCounter & 0xFFF;
+
+        //Only decode the instruction the first time it is executed from this address
+        Instruction& instruction = m_DecodedInstructions[address];
+
+        if (!instruction.Valid)
+        {
+            //Instructions are two bytes, so combine two successive bytes into one instruction
+            byte hi = m_Memory.Read(address);
+            byte lo = m_Memory.Read((address + 1) & 0xFFF);
+
+            instruction = Decode(((word)hi << 8) | lo);
+        }
+
+        //Increment the program counter by 2 to prepare for the next instruction
+        m_Registers.ProgramCounter = address + 2;
+
+        return instruction;
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::WriteMemory(word address, byte value)
+    {
+        m_Memory.Write(address, value);
+        m_SideEffects++;
+
+        //Nothing is decoded past the first 4 KB
+        if (address <= 0xFFF)
+        {
+            InvalidateMemory(address);
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::InvalidateMemory(word address)
+    {
+        //Both instructions that contain this byte have to be decoded again
+        m_DecodedInstructions[address].Valid = false;
+        m_DecodedInstructions[(address - 1) & 0xFFF].Valid = false;
+
+        //Any translated block containing this byte has to be translated again
+        if (m_BlockCache->IsCode(address))
+        {
+            m_BlockCache->Invalidate(address);
+        }
+    }
+
+    void Emulator::Execute(std::uint64_t cycles)
+    {
+        //The only check of the profile, everything below is specialized on it
+        switch (m_Quirks)
+        {
+            case QuirkProfile::CosmacVip: ExecuteWith<CosmacVipQuirks>(cycles); break;
+            case QuirkProfile::SuperChip: ExecuteWith<SuperChipQuirks>(cycles); break;
+            case QuirkProfile::XoChip: ExecuteWith<XoChipQuirks>(cycles); break;
+            default: ExecuteWith<ModernQuirks>(cycles); break;
+        }
+    }
+
+    template<typename Quirks>
+    void Emulator::ExecuteWith(std::uint64_t cycles)
+    {
+        //Still in the idle loop found before and nothing woke it up, so every whole iteration left can be skipped
+        if (m_IdleLoop.Length > 0 && IsIdleState())
+        {
+            cycles %= m_IdleLoop.Length;
+        }
+        else
+        {
+            m_IdleLoop.Length = 0;
+        }
+
+        m_IdleLoop.Cycles = 0;
+
+        BlockCache& cache = *m_BlockCache;
+        Block* block = &cache.Lookup(m_Registers.ProgramCounter);
+
+        while (cycles > 0)
+        {
+            //Translate the block the first time it is reached
+            if (!block->Valid)
+            {
+                block = &cache.Translate(m_Memory, block->Start);
+
+                if (m_StaticProgram && m_StaticProgram->Quirks == Quirks::Profile && !ExecutionProfiler::Enabled)
+                {
+                    AttachStaticBlock(*block);
+                }
+            }
+
+            //Not enough cycles are left for the whole block, so finish one instruction at a time
+            if (block->Length > cycles)
+            {
+                Step<Quirks>(cycles);
+                break;
+            }
+
+            cycles -= block->Length;
+
+            //Only the last instruction of a block can read the program counter
+            m_Registers.ProgramCounter = block->End;
+
+            if (block->Native)
+            {
+                block->Native(this, &m_Registers, m_Memory.GetPages());
+            }
+            else
+            {
+                ExecuteBlock<Quirks>(*block);
+
+                //Compile blocks that keep being interpreted
+                if (m_JitCache && ++block->Heat == JitCache::CompileThreshold)
+                {
+                    m_JitCache->Compile(*m_BlockCache, *block);
+                }
+            }
+
+            //Follow the chain to the next block, or look it up if it's only known now
+            Block* next;
+
+            switch (block->Successors)
+            {
+                case 1: next = block->Next[0]; break;
+                case 2: next = block->Next[(m_Registers.ProgramCounter - block->End) >> 1]; break;
+                default: next = &cache.Lookup(m_Registers.ProgramCounter); break;
+            }
+
+            //A program can only wait in a loop, so look for a repeating state whenever a block jumps back
+            if (next->Start <= block->Start && (block->Waits || next->Waits) && m_IdleLoop.Length == 0)
+            {
+                cycles = DetectIdleLoop(cycles);
+            }
+
+            block = next;
+        }
+
+        //Wherever the last iteration stopped also repeats, so the next call can skip straight away
+        if (m_IdleLoop.Length > 0)
+        {
+            SaveIdleState();
+        }
+    }
+
+    std::uint64_t Emulator::DetectIdleLoop(std::uint64_t cycles)
+    {
+        //The same state as some instructions ago, without anything written to memory or the display in between.
+        //Until a timer ticks or a key changes, every further iteration ends up in this state again
+        if (m_IdleLoop.Cycles > cycles && IsIdleState())
+        {
+            m_IdleLoop.Length = m_IdleLoop.Cycles - cycles;
+            return cycles % m_IdleLoop.Length;
+        }
+
+        SaveIdleState();
+        m_IdleLoop.Cycles = cycles;
+
+        return cycles;
+    }
+
+    bool Emulator::IsIdleState() const
+    {
+        //Registers is compared up to its last member, leaving out the padding
+        constexpr std::size_t registersSize = offsetof(Registers, Variable) + sizeof(Registers::Variable);
+
+        return m_IdleLoop.SideEffects == m_SideEffects && m_IdleLoop.Keys == m_Keys && m_IdleLoop.Random == m_Random.State &&
+            memcmp(&m_IdleLoop.Machine, &m_Registers, registersSize) == 0;
+    }
+
+    void Emulator::SaveIdleState()
+    {
+        m_IdleLoop.Machine = m_Registers;
+        m_IdleLoop.Keys = m_Keys;
+        m_IdleLoop.Random = m_Random.State;
+        m_IdleLoop.SideEffects = m_SideEffects;
+    }
+
+    void Emulator::AttachStaticBlock(Block& block)
+    {
+        const StaticBlock* first = m_StaticProgram->Blocks;
+        const StaticBlock* last = first + m_StaticProgram->Count;
+
+        //The static blocks are sorted by their start address
+        const StaticBlock* match = std::lower_bound(first, last, block.Start, [](const StaticBlock& staticBlock, word start)
+        {
+            return staticBlock.Start < start;
+        });
+
+        if (match == last || match->Start != block.Start || match->Length != block.Length || block.End > 0x1000)
+        {
+            return;
+        }
+
+        //Self-modified code no longer matches what was compiled, so it stays interpreted
+        if (!m_Memory.Matches(block.Start, match->Code, block.End - block.Start))
+        {
+            return;
+        }
+
+        block.Native = match->Function;
+    }
+
+    template<typename Quirks>
+    void Emulator::Step(std::uint64_t cycles)
+    {
+        while (cycles--)
+        {
+            word address = m_Registers.ProgramCounter & 0xFFF;
+
+            //Fetch the decoded instruction
+            const Instruction& instruction = Fetch();
+
+            //Execute it
+            std::uint64_t start = m_Profiler.Begin();
+            ExecuteInstruction<Quirks>(instruction);
+            m_Profiler.End(instruction, address, start);
+        }
+    }
+
+    template<typename Quirks>
+    void Emulator::Interpret(void* context, const Instruction* instruction)
+    {
+        static_cast<Emulator*>(context)->ExecuteInstruction<Quirks>(*instruction);
+    }
+
+    //Compiled code in other files calls these
+    template void Emulator::Interpret<ModernQuirks>(void* context, const Instruction* instruction);
+    template void Emulator::Interpret<CosmacVipQuirks>(void* context, const Instruction* instruction);
+    template void Emulator::Interpret<SuperChipQuirks>(void* context, const Instruction* instruction);
+    template void Emulator::Interpret<XoChipQuirks>(void* context, const Instruction* instruction);
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::ExecuteInstruction(const Instruction& instruction)
+    {
+        //The handlers are inlined into each case
+        switch (instruction.OpCode)
+        {
+            case 0x0: OpCode0<Quirks>(instruction); break;
+            case 0x1: OpCode1(instruction); break;
+            case 0x2: OpCode2(instruction); break;
+            case 0x3: OpCode3<Quirks>(instruction); break;
+            case 0x4: OpCode4<Quirks>(instruction); break;
+            case 0x5: OpCode5<Quirks>(instruction); break;
+            case 0x6: OpCode6(instruction); break;
+            case 0x7: OpCode7(instruction); break;
+            case 0x8: OpCode8<Quirks>(instruction); break;
+            case 0x9: OpCode9<Quirks>(instruction); break;
+            case 0xA: OpCodeA(instruction); break;
+            case 0xB: OpCodeB<Quirks>(instruction); break;
+            case 0xC: OpCodeC(instruction); break;
+            case 0xD: OpCodeD<Quirks>(instruction); break;
+            case 0xE: OpCodeE<Quirks>(instruction); break;
+            case 0xF: OpCodeF<Quirks>(instruction); break;
+        }
+    }
+
+#if defined(CHIP8_DISPATCH_THREADED) && (defined(__GNUC__) || defined(__clang__))
+    template<typename Quirks>
+    void Emulator::ExecuteBlock(const Block& block)
+    {
+        //Threaded code: every handler jumps straight to the handler of the next instruction, so
+        //each opcode gets its own indirect branch which the branch predictor can learn separately
+        static void* const dispatchTable[0xF + 1] =
+        {
+            &&Execute0, &&Execute1, &&Execute2, &&Execute3,
+            &&Execute4, &&Execute5, &&Execute6, &&Execute7,
+            &&Execute8, &&Execute9, &&ExecuteA, &&ExecuteB,
+            &&ExecuteC, &&ExecuteD, &&ExecuteE, &&ExecuteF
+        };
+
+        const Instruction* first = m_BlockCache->Operations(block);
+        const Instruction* instruction = first;
+        const Instruction* end = instruction + block.Length;
+        std::uint64_t start = 0;
+
+        //Jump to the handler of the current instruction, or leave at the end of the block
+        #define CHIP8_DISPATCH()                                    \
+            if (instruction == end)                                 \
+                return;                                             \
+            start = m_Profiler.Begin();                             \
+            goto *dispatchTable[instruction->OpCode]
+
+        //Advance to the next instruction of the block
+        #define CHIP8_NEXT()                                        \
+            m_Profiler.End(*instruction, (block.Start + 2 * (word)(instruction - first)) & 0xFFF, start); \
+            instruction++;                                          \
+            CHIP8_DISPATCH()
+
+        CHIP8_DISPATCH();
+
+        Execute0: OpCode0<Quirks>(*instruction); CHIP8_NEXT();
+        Execute1: OpCode1(*instruction); CHIP8_NEXT();
+        Execute2: OpCode2(*instruction); CHIP8_NEXT();
+        Execute3: OpCode3<Quirks>(*instruction); CHIP8_NEXT();
+        Execute4: OpCode4<Quirks>(*instruction); CHIP8_NEXT();
+        Execute5: OpCode5<Quirks>(*instruction); CHIP8_NEXT();
+        Execute6: OpCode6(*instruction); CHIP8_NEXT();
+        Execute7: OpCode7(*instruction); CHIP8_NEXT();
+        Execute8: OpCode8<Quirks>(*instruction); CHIP8_NEXT();
+        Execute9: OpCode9<Quirks>(*instruction); CHIP8_NEXT();
+        ExecuteA: OpCodeA(*instruction); CHIP8_NEXT();
+        ExecuteB: OpCodeB<Quirks>(*instruction); CHIP8_NEXT();
+        ExecuteC: OpCodeC(*instruction); CHIP8_NEXT();
+        ExecuteD: OpCodeD<Quirks>(*instruction); CHIP8_NEXT();
+        ExecuteE: OpCodeE<Quirks>(*instruction); CHIP8_NEXT();
+        ExecuteF: OpCodeF<Quirks>(*instruction); CHIP8_NEXT();
+
+        #undef CHIP8_NEXT
+        #undef CHIP8_DISPATCH
+    }
+#else
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::ExecuteBlock(const Block& block)
+    {
+        const Instruction* instruction = m_BlockCache->Operations(block);
+        const Instruction* end = instruction + block.Length;
+
+        for (word address = block.Start; instruction != end; instruction++, address += 2)
+        {
+            std::uint64_t start = m_Profiler.Begin();
+            ExecuteInstruction<Quirks>(*instruction);
+            m_Profiler.End(*instruction, address & 0xFFF, start);
+        }
+    }
+#endif
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE word Emulator::GetSkipLength() const
+    {
+        if (!Quirks::XoChip)
+        {
+            return 2;
+        }
+
+        //The program counter is already past the skip, at the instruction that might be skipped
+        word address = m_Registers.ProgramCounter & 0xFFF;
+        bool longInstruction = m_Memory.Read(address) == 0xF0 && m_Memory.Read((address + 1) & 0xFFF) == 0x00;
+
+        return longInstruction ? 4 : 2;
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode0(const Instruction& instruction)
+    {
+        //Get the decoded arguments of the instruction
+        word args = instruction.NNN;
+
+        //SCD nibble
+        if (Quirks::Extended && (args & 0xFF0) == 0x0C0)
+        {
+            //Scroll the display down by N rows
+            m_Display.ScrollDown(instruction.N);
+            m_SideEffects++;
+            return;
+        }
+
+        //SCU nibble
+        if (Quirks::XoChip && (args & 0xFF0) == 0x0D0)
+        {
+            //Scroll the display up by N rows
+            m_Display.ScrollUp(instruction.N);
+            m_SideEffects++;
+            return;
+        }
+
+        switch (args)
+        {
+            //CLS
+            case 0x0E0:
+            {
+                //Reset all the bits of the selected planes
+                m_Display.Clear();
+                m_SideEffects++;
+                break;
+            }
+
+            //RET
+            case 0x0EE:
+            {
+                //Make sure the interpreter is currently in a subroutine
+                if (m_Registers.StackPointer < 0)
+                {
+                    //TODO: Implement some kind of stack underflow error
+                    break;
+                }
+
+                //Set the program counter to the address at the top of the stack
+                m_Registers.ProgramCounter = m_Registers.Stack[m_Registers.StackPointer];
+
+                //Subtract one from the stack pointer
+                m_Registers.StackPointer--;
+
+                break;
+            }
+
+            //SCR
+            case 0x0FB:
+            {
+                if (Quirks::Extended)
+                {
+                    //Scroll the display right by 4 columns
+                    m_Display.ScrollRight();
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //SCL
+            case 0x0FC:
+            {
+                if (Quirks::Extended)
+                {
+                    //Scroll the display left by 4 columns
+                    m_Display.ScrollLeft();
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //EXIT
+            case 0x0FD:
+            {
+                //There is nothing to exit to, so stay on this instruction like a jump to itself
+                if (Quirks::Extended)
+                {
+                    m_Registers.ProgramCounter -= 2;
+                }
+
+                break;
+            }
+
+            //LOW, HIGH
+            case 0x0FE:
+            case 0x0FF:
+            {
+                if (Quirks::Extended)
+                {
+                    //Switch the resolution, which clears the display
+                    m_Display.SetHighResolution(args == 0x0FF);
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //SYS addr
+            default:
+            {
+                //This instruction is ignored by most modern interpreters
+
+                break;
+            }
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCode1(const Instruction& instruction)
+    {
+        //JP addr
+        {
+            //Get the address
+            word args = instruction.NNN;
+
+            //Set the program counter to NNN
+            m_Registers.ProgramCounter = args;
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCode2(const Instruction& instruction)
+    {
+        //CALL addr
+        {
+            //Check to see if there is space left in the stack
+            if (m_Registers.StackPointer >= MaximumStackCount - 1)
+            {
+                //TODO: Implement some kind of stack overflow error
+                return;
+            }
+
+            //Get the address
+            word args = instruction.NNN;
+
+            //Increment the stack pointer
+            m_Registers.StackPointer++;
+
+            //Put the current program counter on the top of the stack
+            m_Registers.Stack[m_Registers.StackPointer] = m_Registers.ProgramCounter;
+
+            //Set the program counter to the address
+            m_Registers.ProgramCounter = args;
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode3(const Instruction& instruction)
+    {
+        //SE VX, byte
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte nn = instruction.NN;
+
+            //Get the value in VX
+            byte vx = m_Registers.Variable[x];
+
+            //Compare register VX to NN
+            bool comparison = vx == nn;
+
+            //If they are equal, skip the next instruction
+            m_Registers.ProgramCounter += comparison * GetSkipLength<Quirks>();
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode4(const Instruction& instruction)
+    {
+        //SNE VX, byte
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte nn = instruction.NN;
+
+            //Get the value in VX
+            byte vx = m_Registers.Variable[x];
+
+            //Compare register VX to NN
+            bool comparison = vx != nn;
+
+            //If they are not equal, skip the next instruction
+            m_Registers.ProgramCounter += comparison * GetSkipLength<Quirks>();
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode5(const Instruction& instruction)
+    {
+        //LD [I], VX - VY, LD VX - VY, [I]
+        if (Quirks::XoChip && (instruction.N == 0x2 || instruction.N == 0x3))
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte y = instruction.Y;
+
+            //The registers go from VX to VY in either direction, I is left alone
+            byte count = (x < y ? y - x : x - y) + 1;
+            sbyte direction = x < y ? 1 : -1;
+
+            for (byte i = 0; i < count; i++)
+            {
+                word address = (m_Registers.Index + i) & Quirks::AddressMask;
+                byte& vi = m_Registers.Variable[x + direction * i];
+
+                if (instruction.N == 0x2)
+                {
+                    WriteMemory(address, vi);
+                }
+                else
+                {
+                    vi = m_Memory.Read(address);
+                }
+            }
+
+            return;
+        }
+
+        //SE VX, VY
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte y = instruction.Y;
+
+            //Get the values of VX and VY
+            byte vx = m_Registers.Variable[x];
+            byte vy = m_Registers.Variable[y];
+
+            //Compare register VX to register VY
+            bool comparison = vx == vy;
+
+            //If they are equal, skip the next instruction
+            m_Registers.ProgramCounter += comparison * GetSkipLength<Quirks>();
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCode6(const Instruction& instruction)
+    {
+        //LD VX, byte
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte nn = instruction.NN;
+
+            //Put the value of NN into register VX
+            m_Registers.Variable[x] = nn;
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCode7(const Instruction& instruction)
+    {
+        //ADD VX, byte
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte nn = instruction.NN;
+
+            //Get the value of VX
+            byte vx = m_Registers.Variable[x];
+
+            //Add the value NN to the value of register VX and store the value of VX
+            m_Registers.Variable[x] = vx + nn;
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode8(const Instruction& instruction)
+    {
+        //Get the decoded arguments of the instruction
+        byte x = instruction.X;
+        byte y = instruction.Y;
+
+        //Get the values of VX and VY
+        byte vx = m_Registers.Variable[x];
+        byte vy = m_Registers.Variable[y];
+
+        //Get the specific instruction
+        byte specificInstruction = instruction.N;
+
+        switch (specificInstruction)
+        {
+            //LD VX, VY
+            case 0x0:
+            {
+                //Store the value of VY into register VX
+                m_Registers.Variable[x] = vy;
+
+                break;
+            }
+
+            //OR VX, VY
+            case 0x1:
+            {
+                //Perform a bitwise OR on the values in VX and VY, then store the value in VX
+                m_Registers.Variable[x] = vx | vy;
+
+                //The original interpreter left VF cleared
+                if (Quirks::LogicResetsVF)
+                {
+                    m_Registers.Variable[0xF] = 0;
+                }
+
+                break;
+            }
+
+            //AND VX, VY
+            case 0x2:
+            {
+                //Perform a bitwise AND on the values in VX and VY, then store the value in VX
+                m_Registers.Variable[x] = vx & vy;
+
+                if (Quirks::LogicResetsVF)
+                {
+                    m_Registers.Variable[0xF] = 0;
+                }
+
+                break;
+            }
+
+            //XOR VX, VY
+            case 0x3:
+            {
+                //Perform a bitwise XOR on the values in VX and VY, then store the value in VX
+                m_Registers.Variable[x] = vx ^ vy;
+
+                if (Quirks::LogicResetsVF)
+                {
+                    m_Registers.Variable[0xF] = 0;
+                }
+
+                break;
+            }
+
+            //ADD VX, VY
+            case 0x4:
+            {
+                //Add the values of VX and VY together
+                word result = vx + vy;
+
+                //If the result is greater than 8 bits, set VF to 1, otherwise 0
+                bool carry = (result >> 8) & 0xFF;
+                m_Registers.Variable[0xF] = carry;
+
+                //Store the lower 8 bits into VX
+                m_Registers.Variable[x] = result & 0xFF;
+
+                break;
+            }
+
+            //SUB VX, VY
+            case 0x5:
+            {
+                //If VX is greater than VY, set VF to 1, otherwise 0
+                bool nBorrow = vx > vy;
+                m_Registers.Variable[0xF] = nBorrow;
+
+                //Subtract VY from VX and store it in VX
+                m_Registers.Variable[x] = vx - vy;
+
+                break;
+            }
+
+            //SHR VX {, VY}
+            case 0x6:
+            {
+                //Shift VY into VX, or VX in place
+                byte value = Quirks::ShiftReadsVY ? vy : vx;
+
+                //Get the least significant bit and store it in VF
+                m_Registers.Variable[0xF] = value & 0x01;
+
+                //Divide it by 2
+                m_Registers.Variable[x] = value / 2;
+
+                break;
+            }
+
+            //SUBN VX, VY
+            case 0x7:
+            {
+                //If VY is greater than VX, set VF to 1, otherwise 0
+                bool nBorrow = vy > vx;
+                m_Registers.Variable[0xF] = nBorrow;
+
+                //Subtract VX from VY and store it in VX
+                m_Registers.Variable[x] = vy - vx;
+
+                break;
+            }
+
+            //SHL VX {, VY}
+            case 0xE:
+            {
+                //Shift VY into VX, or VX in place
+                byte value = Quirks::ShiftReadsVY ? vy : vx;
+
+                //Get the most significant bit and store it in VF
+                m_Registers.Variable[0xF] = (value >> 7) & 0x01;
+
+                //Multiply it by 2
+                m_Registers.Variable[x] = value * 2;
+
+                break;
+            }
+
+            //No known opcodes
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCode9(const Instruction& instruction)
+    {
+        //SNE VX, VY
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte y = instruction.Y;
+
+            //Get the values in VX and VY
+            byte vx = m_Registers.Variable[x];
+            byte vy = m_Registers.Variable[y];
+
+            //Compare the variables of VX and VY
+            bool comparison = vx != vy;
+
+            //If they are not equal, skip the next instruction
+            m_Registers.ProgramCounter += comparison * GetSkipLength<Quirks>();
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCodeA(const Instruction& instruction)
+    {
+        //LD I, addr
+        {
+            //Get the decoded arguments of the instruction
+            word args = instruction.NNN;
+
+            //Set the value of register I to NNN
+            m_Registers.Index = args;
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCodeB(const Instruction& instruction)
+    {
+        //JP V0, addr
+        {
+            //Get the decoded arguments of the instruction
+            word args = instruction.NNN;
+
+            //Get the value in V0, or in VX with X the top nibble of the address
+            byte v0 = m_Registers.Variable[Quirks::JumpAddsVX ? instruction.X : 0x0];
+
+            //Set the program counter to V0 + NNN
+            m_Registers.ProgramCounter = v0 + args;
+        }
+    }
+
+    CHIP8_FORCE_INLINE void Emulator::OpCodeC(const Instruction& instruction)
+    {
+        //RND VX, byte
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            word nn = instruction.NN;
+
+            //Get a random byte from this emulator's generator
+            byte result = m_Random.Next();
+
+            //Store the result bitwise ANDed with NN and store it in VX
+            m_Registers.Variable[x] = result & nn;
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCodeD(const Instruction& instruction)
+    {
+        //DRAW VX, VY, nibble
+        {
+            //Get the decoded arguments of the instruction
+            byte x = instruction.X;
+            byte y = instruction.Y;
+            byte n = instruction.N;
+
+            //SUPER-CHIP and XO-CHIP draw through the display, which knows the resolution and the planes
+            if (Quirks::Extended)
+            {
+                DrawExtended<Quirks>(x, y, n);
+                return;
+            }
+
+            //Get the values in VX and VY, wrapped onto the screen
+            byte vx = m_Registers.Variable[x] % Display::LowResWidth;
+            byte vy = m_Registers.Variable[y] % Display::LowResHeight;
+
+            //Any pixel turned off by this sprite is a collision
+            std::uint64_t collision = 0;
+
+            //Clipped sprites stop at the bottom of the screen
+            byte rows = Quirks::ClipSprites ? std::min<byte>(n, Display::LowResHeight - vy) : n;
+
+            //Draw each sprite line by line
+            for (byte i = 0; i < rows; i++)
+            {
+                //Get the current line of this sprite
+                byte currentLine = m_Memory.Read((m_Registers.Index + i) & Quirks::AddressMask);
+
+                //Move the line to the leftmost pixels of a row, then shift it to VX so it's cut off at the right edge,
+                //or rotate it so it wraps around
+                std::uint64_t sprite = (std::uint64_t)currentLine << (Display::LowResWidth - 8);
+                sprite = Quirks::ClipSprites ? sprite >> vx : (sprite >> vx) | (sprite << ((Display::LowResWidth - vx) % Display::LowResWidth));
+
+                //Rows wrap around to the top of the screen, clipped sprites never get that far
+                std::uint64_t& row = m_Display.GetPlane(0).Left[(vy + i) % Display::LowResHeight];
+
+                //Check for collisions, then flip the whole line at once
+                collision |= row & sprite;
+                row ^= sprite;
+            }
+
+            //Set VF if any pixel was turned off
+            m_Registers.Variable[0xF] = collision != 0;
+            m_SideEffects++;
+        }
+    }
+
+    template<typename Quirks>
+    void Emulator::DrawExtended(byte x, byte y, byte n)
+    {
+        //Get the values in VX and VY, wrapped onto the screen of the current resolution
+        byte vx = m_Registers.Variable[x] & (m_Display.GetWidth() - 1);
+        byte vy = m_Registers.Variable[y] & (m_Display.GetHeight() - 1);
+
+        //DRW VX, VY, 0 draws a 16x16 sprite, two bytes per row
+        bool wide = n == 0;
+        byte rows = wide ? 16 : n;
+
+        //Every selected plane takes the next sprite in memory
+        word address = m_Registers.Index;
+        bool collision = false;
+
+        for (byte plane = 0; plane < Display::PlaneCount; plane++)
+        {
+            if (!(m_Display.GetSelectedPlanes() & (1 << plane)))
+            {
+                continue;
+            }
+
+            word sprite[16];
+            for (byte i = 0; i < rows; i++)
+            {
+                byte hi = m_Memory.Read(address++ & Quirks::AddressMask);
+                byte lo = wide ? m_Memory.Read(address++ & Quirks::AddressMask) : 0;
+                sprite[i] = (word)(hi << 8) | lo;
+            }
+
+            collision |= m_Display.Draw(plane, vx, vy, sprite, rows, Quirks::ClipSprites);
+        }
+
+        //Set VF if any pixel was turned off
+        m_Registers.Variable[0xF] = collision;
+        m_SideEffects++;
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCodeE(const Instruction& instruction)
+    {
+        //Get the decoded arguments of the instruction
+        byte x = instruction.X;
+
+        //Get the value of VX
+        byte vx = m_Registers.Variable[x];
+
+        //Get the specific instruction
+        byte specificInstruction = instruction.NN;
+
+        switch (specificInstruction)
+        {
+            //SKP VX
+            case 0x9E:
+            {
+                //Check the current state of the key
+                bool keyPressed = (m_Keys >> (vx & 0xF)) & 0x1;
+
+                //If the key is pressed, skip the next instruction
+                m_Registers.ProgramCounter += keyPressed * GetSkipLength<Quirks>();
+
+                break;
+            }
+
+            //SKNP VX
+            case 0xA1:
+            {
+                //Check the current state of the key
+                bool keyPressed = (m_Keys >> (vx & 0xF)) & 0x1;
+
+                //If the key is not pressed, skip the next instruction
+                m_Registers.ProgramCounter += (!keyPressed) * GetSkipLength<Quirks>();
+
+                break;
+            }
+
+            //No known opcodes
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    template<typename Quirks>
+    CHIP8_FORCE_INLINE void Emulator::OpCodeF(const Instruction& instruction)
+    {
+        //Get the decoded arguments of the instruction
+        byte x = instruction.X;
+
+        //Get the value of VX
+        byte vx = m_Registers.Variable[x];
+
+        //Get the specific instruction
+        byte specificInstruction = instruction.NN;
+
+        switch (specificInstruction)
+        {
+            //LD I, long
+            case 0x00:
+            {
+                if (Quirks::XoChip && x == 0x0)
+                {
+                    //The address is the word after this instruction, which is skipped
+                    word address = m_Registers.ProgramCounter & 0xFFF;
+                    m_Registers.Index = (word)(m_Memory.Read(address) << 8) | m_Memory.Read((address + 1) & 0xFFF);
+                    m_Registers.ProgramCounter = address + 2;
+                }
+
+                break;
+            }
+
+            //PLANE n
+            case 0x01:
+            {
+                if (Quirks::XoChip)
+                {
+                    //X selects the planes to draw to
+                    m_Display.SelectPlanes(x);
+                }
+
+                break;
+            }
+
+            //AUDIO
+            case 0x02:
+            {
+                if (Quirks::XoChip && x == 0x0)
+                {
+                    //Load the 16 bytes at I into the audio pattern
+                    for (byte i = 0; i < sizeof(m_Registers.Pattern); i++)
+                    {
+                        m_Registers.Pattern[i] = m_Memory.Read((m_Registers.Index + i) & Quirks::AddressMask);
+                    }
+
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //LD VX, DT
+            case 0x07:
+            {
+                //Place the value of the delay timer into VX
+                m_Registers.Variable[x] = m_Registers.DelayTimer;
+
+                break;
+            }
+
+            //LD VX, K
+            case 0x0A:
+            {
+                //Get the lowest key that is held down, if any
+                sbyte pressedKey = -1;
+                for (sbyte key = 0xF; key >= 0x0; key--)
+                {
+                    pressedKey = ((m_Keys >> key) & 0x1) ? key : pressedKey;
+                }
+                bool keyPressed = pressedKey >= 0x0;
+
+                //If there is a pressed key, store the pressed key in VX
+                m_Registers.Variable[x] = keyPressed ? pressedKey : vx;
+
+                //Halt execution otherwise
+                m_Registers.ProgramCounter -= (!keyPressed) * 2;
+
+                break;
+            }
+
+            //LD DT, VX
+            case 0x15:
+            {
+                //Set the delay timer to the value in VX
+                m_Registers.DelayTimer = vx;
+
+                break;
+            }
+
+            //LD ST, VX
+            case 0x18:
+            {
+                //Set the sound timer to the value in VX
+                m_Registers.SoundTimer = vx;
+
+                break;
+            }
+
+            //ADD I, VX
+            case 0x1E:
+            {
+                //Set the value of the index register to the sum of itself and VX
+                m_Registers.Index = m_Registers.Index + vx;
+
+                break;
+            }
+
+            //LD F, VX
+            case 0x29:
+            {
+                //Set the index register to the location for the hexadecimal sprite corresponding to VX
+                m_Registers.Index = 5 * vx;
+
+                break;
+            }
+
+            //LD HF, VX
+            case 0x30:
+            {
+                if (Quirks::Extended)
+                {
+                    //Set the index register to the location for the big hexadecimal sprite corresponding to VX
+                    m_Registers.Index = BigFontAddress + 10 * (vx & 0xF);
+                }
+
+                break;
+            }
+
+            //LD B, VX
+            case 0x33:
+            {
+                //Store the ones digit of vx in index + 2
+                WriteMemory((m_Registers.Index + 2) & Quirks::AddressMask, vx % 10);
+
+                //Store the tens digit of vx in index + 1
+                vx /= 10;
+                WriteMemory((m_Registers.Index + 1) & Quirks::AddressMask, vx % 10);
+
+                //Store the hundreds digit of vx in index
+                vx /= 10;
+                WriteMemory((m_Registers.Index + 0) & Quirks::AddressMask, vx % 10);
+
+                break;
+            }
+
+            //PITCH VX
+            case 0x3A:
+            {
+                if (Quirks::XoChip)
+                {
+                    //Set the playback rate of the audio pattern
+                    m_Registers.Pitch = vx;
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //LD [I], VX
+            case 0x55:
+            {
+                //Go through all the values between 0 and x (inclusive)
+                for (byte i = 0; i <= x; i++)
+                {
+                    //Get the value of the current variable register
+                    byte vi = m_Registers.Variable[i];
+
+                    //Store the value of VI in memory at index + i
+                    WriteMemory((m_Registers.Index + i) & Quirks::AddressMask, vi);
+                }
+
+                //The original interpreter left I past the last register
+                if (Quirks::LoadStoreAdvancesIndex)
+                {
+                    m_Registers.Index += x + 1;
+                }
+
+                break;
+            }
+
+            //LD VX, [I]
+            case 0x65:
+            {
+                //Go through all the values between 0 and x (inclusive)
+                for (byte i = 0; i <= x; i++)
+                {
+                    //Store the value at memory location index + i in vi
+                    m_Registers.Variable[i] = m_Memory.Read((m_Registers.Index + i) & Quirks::AddressMask);
+                }
+
+                if (Quirks::LoadStoreAdvancesIndex)
+                {
+                    m_Registers.Index += x + 1;
+                }
+
+                break;
+            }
+
+            //LD R, VX
+            case 0x75:
+            {
+                if (Quirks::Extended)
+                {
+                    //Save V0 to VX in the user flags
+                    memcpy(m_Registers.Flags, m_Registers.Variable, x + 1);
+                    m_SideEffects++;
+                }
+
+                break;
+            }
+
+            //LD VX, R
+            case 0x85:
+            {
+                if (Quirks::Extended)
+                {
+                    //Restore V0 to VX from the user flags
+                    memcpy(m_Registers.Variable, m_Registers.Flags, x + 1);
+                }
+
+                break;
+            }
+
+            //No known opcodes
+            default:
+            {
+                break;
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -1,64 +1,245 @@
-#pragma once
-
-#include <functional>
-
-#include "Base.h"
-
-extern int main(int argc, char** argv);
-
-namespace CHIP8
-{
-    class Emulator
-    {
-        friend int ::main(int argc, char** argv);
-
-    public:
-        Emulator();
-        ~Emualtor();
-
-    private:
-        using OpCodeFunction = std::function<void(word)>;
-
-        byte m_Memory[0xFFF + 1] = { 0 };
-        bool m_Display[64 * 32] = { 0 };
-        OpCodeFunction m_OpCodeFunctions[0xF + 1] = { 0 };
-
-        bool m_Running = false;
-
-        struct
-        {
-            word ProgramCounter = 0x0200;
-            word Index = 0x0000;
-
-            constexpr byte MaximumStackCount = 16;
-
-            word Stack[MaximumStackCount] = { 0 };
-            sbyte StackPointer = -1;
-            byte DelayTimer = 0;
-            byte SoundTimer = 0;
-
-            byte Variable[0xF + 1] = { 0 };
-        } m_Registers;
-
-        void Run();
-
-    #pragma region
-        void OpCode0(word instruction);
-        void OpCode1(word instruction);
-        void OpCode2(word instruction);
-        void OpCode3(word instruction);
-        void OpCode4(word instruction);
-        void OpCode5(word instruction);
-        void OpCode6(word instruction);
-        void OpCode7(word instruction);
-        void OpCode8(word instruction);
-        void OpCode9(word instruction);
-        void OpCodeA(word instruction);
-        void OpCodeB(word instruction);
-        void OpCodeC(word instruction);
-        void OpCodeD(word instruction);
-        void OpCodeE(word instruction);
-        void OpCodeF(word instruction);
-    #pragma endregion
-    };
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/BlockCache.h"
+#include "Emulator/Display.h"
+#include "Emulator/Instruction.h"
+#include "Emulator/JitCache.h"
+#include "Emulator/Memory.h"
+#include "Emulator/MemoryImage.h"
+#include "Emulator/Profiler.h"
+#include "Emulator/Quirks.h"
+#include "Emulator/Random.h"
+#include "Emulator/Registers.h"
+#include "Emulator/RomCache.h"
+#include "Emulator/StaticProgram.h"
+
+extern int main(int argc, char** argv);
+
+namespace CHIP8
+{
+    //How the emulator executes translated blocks
+    enum class ExecutionMode
+    {
+        //Every block is interpreted
+        Interpreter,
+
+        //Hot blocks are compiled to native code, if the host supports it
+        Jit
+    };
+
+    class Emulator
+    {
+        friend int ::main(int argc, char** argv);
+
+    public:
+        Emulator(std::shared_ptr<const Rom> rom = nullptr);
+        ~Emulator();
+
+        //Resets the emulator with a copy of the program at 0x200
+        void LoadProgram(const byte* program, std::size_t size);
+
+        //Resets the emulator with a ROM at 0x200, anything decoded or translated is only dropped if it's a different ROM
+        void LoadRom(std::shared_ptr<const Rom> rom);
+
+        //Puts memory, the display, the registers and the keys back to how they were right after loading the ROM.
+        //The seed, the execution mode and the static program are kept
+        void Reset();
+
+        const std::shared_ptr<const Rom>& GetRom() const { return m_Rom; }
+
+        //Turns this emulator into a copy of another one, which continues from the same instruction.
+        //Memory is shared copy-on-write, so only the registers and the display are copied. Only what was decoded
+        //from bytes that differ from the parent is dropped. The execution mode is kept
+        void ForkFrom(const Emulator& parent);
+
+        //A new emulator forked from this one, in the same execution mode
+        std::unique_ptr<Emulator> Fork() const;
+
+        //The version written by SaveState(), states of other versions are rejected
+        static constexpr word StateVersion = 2;
+
+        //Magic and version, memory, every plane of the display and its mode, the registers and the random number generator
+        static constexpr std::size_t StateSize = 4 + 2 + Memory::Size + Display::PlaneCount * Display::Height * 2 * 8 + 1 + 1 +
+            2 + 2 + Registers::MaximumStackCount * 2 + 1 + 1 + 1 + 0x10 + 0x10 + 0x10 + 1 + 4;
+
+        //Writes the state of the machine to StateSize bytes, little-endian so it can be loaded on any host
+        void SaveState(byte* state) const;
+        std::vector<byte> SaveState() const;
+
+        //Restores a state written by SaveState(), returns false if it isn't one.
+        //Only the bytes of memory that differ are written, so everything decoded from the rest is kept
+        bool LoadState(const byte* state, std::size_t size);
+
+        //Seeds the random number generator used by RND, so runs can be reproduced
+        void SetSeed(std::uint32_t seed) { m_Random.Seed(seed); }
+
+        //Sets the keys held down, bit N is key N
+        void SetKeys(word keys) { m_Keys = keys; }
+        void SetKey(byte key, bool pressed) { m_Keys = (m_Keys & ~(1 << key)) | (pressed << key); }
+
+        //Executes the given number of instructions, a translated block at a time.
+        //The timers are left alone, a Scheduler ticks them in step with the instructions.
+        //Loops waiting for a timer or a key are detected, the instructions they would spin for are skipped
+        void Execute(std::uint64_t cycles);
+
+        //Counts the delay and sound timers down by one, they are meant to be ticked at 60 Hz
+        void TickTimers();
+
+        const Display& GetDisplay() const { return m_Display; }
+
+        const Registers& GetRegisters() const { return m_Registers; }
+
+        //Reads a byte of memory without executing anything, all 64 KB can be read whatever the profile
+        byte ReadMemory(word address) const { return m_Memory.Read(address); }
+
+        //Counts the handlers and addresses executed, only builds with CHIP8_ENABLE_PROFILER collect anything.
+        //Those builds interpret every instruction, so compiled blocks don't hide any of them
+        const ExecutionProfiler& GetProfiler() const { return m_Profiler; }
+        ExecutionProfiler& GetProfiler() { return m_Profiler; }
+
+        //Switches between interpreting and compiling blocks, falls back to interpreting without JIT support
+        void SetExecutionMode(ExecutionMode mode);
+        ExecutionMode GetExecutionMode() const { return m_JitCache ? ExecutionMode::Jit : ExecutionMode::Interpreter; }
+
+        //Uses the blocks of a recompiled ROM wherever memory still matches the code they were compiled from.
+        //Only used while the emulator runs the quirk profile the program was recompiled for
+        void SetStaticProgram(const StaticProgram* program) { m_StaticProgram = program; m_BlockCache->Flush(); }
+
+        //Selects the variant of CHIP-8 to behave like, every compiled block is dropped. Kept across resets
+        void SetQuirks(QuirkProfile profile);
+        QuirkProfile GetQuirks() const { return m_Quirks; }
+
+        //Interprets an instruction on behalf of compiled code, the context is the emulator.
+        //Instantiated for every profile, compiled code calls the one of the profile it was compiled for
+        template<typename Quirks>
+        static void Interpret(void* context, const Instruction* instruction);
+
+    private:
+        static constexpr byte MaximumStackCount = Registers::MaximumStackCount;
+
+        Memory m_Memory;
+        Display m_Display;
+
+        //Decoded instructions, one entry per address in memory
+        Instruction m_DecodedInstructions[0xFFF + 1];
+
+        //Translated blocks of instructions, indexed by their start address
+        std::unique_ptr<BlockCache> m_BlockCache;
+
+        //Native code compiled from hot blocks, only present in ExecutionMode::Jit
+        std::unique_ptr<JitCache> m_JitCache;
+
+        //Blocks compiled ahead of time by the recompiler, if any
+        const StaticProgram* m_StaticProgram = nullptr;
+
+        QuirkProfile m_Quirks = QuirkProfile::Modern;
+
+        //The ROM loaded at 0x200, if it came from the ROM cache
+        std::shared_ptr<const Rom> m_Rom;
+
+        Registers m_Registers;
+
+        //The keys held down, bit N is key N
+        word m_Keys = 0;
+
+        //The random number generator used by RND, every emulator has its own so they can run on separate threads
+        Random m_Random;
+
+        //Counts the writes to memory and the display, a loop that makes any isn't idle
+        std::uint64_t m_SideEffects = 0;
+
+        //A state of the machine that comes back every Length instructions, until a timer ticks or a key changes
+        struct IdleLoop
+        {
+            Registers Machine;
+            word Keys = 0;
+            std::uint32_t Random = 0;
+            std::uint64_t SideEffects = 0;
+
+            //The instructions that were left to execute when the state was saved, 0 if it wasn't saved by this Execute()
+            std::uint64_t Cycles = 0;
+
+            //The instructions one iteration takes, 0 if the machine isn't known to be idle
+            std::uint64_t Length = 0;
+        };
+
+        IdleLoop m_IdleLoop;
+
+        ExecutionProfiler m_Profiler;
+
+        //Execute() with the handlers of a quirk profile, picked once per call
+        template<typename Quirks>
+        void ExecuteWith(std::uint64_t cycles);
+
+        //Executes the given number of instructions, one instruction at a time
+        template<typename Quirks>
+        void Step(std::uint64_t cycles);
+
+        //Executes a single decoded instruction
+        template<typename Quirks>
+        void ExecuteInstruction(const Instruction& instruction);
+
+        //Saves the state on a jump back, or finds it idle if the state was saved before. Returns the cycles
+        //that are left, minus every whole iteration that can be skipped
+        std::uint64_t DetectIdleLoop(std::uint64_t cycles);
+
+        //Whether the machine is in the state saved by SaveIdleState()
+        bool IsIdleState() const;
+        void SaveIdleState();
+
+        //Resets everything but memory
+        void ResetMachine();
+
+        //Writes back every byte of memory that differs from the given memory
+        void RestoreMemory(const byte* memory);
+
+        //What memory looks like after a reset
+        const MemoryImage& GetImage() const;
+
+        //Attaches the matching block of the static program to a freshly translated block
+        void AttachStaticBlock(Block& block);
+
+        //Executes every instruction of a translated block using the dispatch core selected at build time
+        template<typename Quirks>
+        void ExecuteBlock(const Block& block);
+
+        //Returns the decoded instruction at the program counter and advances it by 2
+        const Instruction& Fetch();
+
+        //Writes a byte to memory, invalidating any decoded instruction that contains it.
+        //The address is masked by the caller, to the bits its profile can address
+        void WriteMemory(word address, byte value);
+
+        //Invalidates every decoded instruction and translated block containing the byte at the address
+        void InvalidateMemory(word address);
+
+        //How far a skip jumps, XO-CHIP skips both words of F000 NNNN at once
+        template<typename Quirks>
+        word GetSkipLength() const;
+
+    #pragma region
+        template<typename Quirks> void OpCode0(const Instruction& instruction);
+        void OpCode1(const Instruction& instruction);
+        void OpCode2(const Instruction& instruction);
+        template<typename Quirks> void OpCode3(const Instruction& instruction);
+        template<typename Quirks> void OpCode4(const Instruction& instruction);
+        template<typename Quirks> void OpCode5(const Instruction& instruction);
+        void OpCode6(const Instruction& instruction);
+        void OpCode7(const Instruction& instruction);
+        template<typename Quirks> void OpCode8(const Instruction& instruction);
+        template<typename Quirks> void OpCode9(const Instruction& instruction);
+        void OpCodeA(const Instruction& instruction);
+        template<typename Quirks> void OpCodeB(const Instruction& instruction);
+        void OpCodeC(const Instruction& instruction);
+        template<typename Quirks> void OpCodeD(const Instruction& instruction);
+        template<typename Quirks> void DrawExtended(byte x, byte y, byte n);
+        template<typename Quirks> void OpCodeE(const Instruction& instruction);
+        template<typename Quirks> void OpCodeF(const Instruction& instruction);
+    #pragma endregion
+    };
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "Emulator/EmulatorPool.h"
+
+#include <utility>
+
+namespace CHIP8
+{
+    void EmulatorPool::Returner::operator()(Emulator* emulator) const
+    {
+        if (m_Pool)
+        {
+            m_Pool->Release(emulator);
+        }
+        else
+        {
+            delete emulator;
+        }
+    }
+
+    EmulatorPool::EmulatorPool(std::size_t capacity)
+    {
+        m_Idle.reserve(capacity);
+
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            m_Idle.push_back(std::make_unique<Emulator>());
+        }
+    }
+
+    EmulatorPool::~EmulatorPool()
+    {
+
+    }
+
+    EmulatorPool::Handle EmulatorPool::Acquire(std::shared_ptr<const Rom> rom)
+    {
+        std::unique_ptr<Emulator> emulator = Take(rom);
+        emulator->LoadRom(std::move(rom));
+
+        return Handle(emulator.release(), Returner(this));
+    }
+
+    EmulatorPool::Handle EmulatorPool::Fork(const Emulator& parent)
+    {
+        std::unique_ptr<Emulator> emulator = Take(parent.GetRom());
+        emulator->ForkFrom(parent);
+
+        return Handle(emulator.release(), Returner(this));
+    }
+
+    std::unique_ptr<Emulator> EmulatorPool::Take(const std::shared_ptr<const Rom>& rom)
+    {
+        std::unique_ptr<Emulator> emulator;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (!m_Idle.empty())
+            {
+                //An emulator that already ran this ROM only has to undo its writes
+                std::size_t match = m_Idle.size() - 1;
+
+                for (std::size_t i = 0; i < m_Idle.size(); i++)
+                {
+                    if (m_Idle[i]->GetRom() == rom)
+                    {
+                        match = i;
+                        break;
+                    }
+                }
+
+                std::swap(m_Idle[match], m_Idle.back());
+                emulator = std::move(m_Idle.back());
+                m_Idle.pop_back();
+            }
+        }
+
+        if (!emulator)
+        {
+            emulator = std::make_unique<Emulator>();
+        }
+
+        return emulator;
+    }
+
+    std::size_t EmulatorPool::GetIdleCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Idle.size();
+    }
+
+    void EmulatorPool::Release(Emulator* emulator)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Idle.emplace_back(emulator);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Emulator/Emulator.h"
+#include "Emulator/RomCache.h"
+
+namespace CHIP8
+{
+    //Recycles emulators between short runs, so a run costs a reset instead of an allocation.
+    //The pool has to outlive every emulator taken from it.
+    class EmulatorPool
+    {
+    public:
+        //Hands an emulator back to its pool instead of deleting it
+        class Returner
+        {
+        public:
+            Returner(EmulatorPool* pool = nullptr)
+                : m_Pool(pool)
+            {
+            }
+
+            void operator()(Emulator* emulator) const;
+
+        private:
+            EmulatorPool* m_Pool;
+        };
+
+        using Handle = std::unique_ptr<Emulator, Returner>;
+
+        //Creates the given number of emulators up front, taking that many at once never allocates
+        EmulatorPool(std::size_t capacity = 0);
+        ~EmulatorPool();
+
+        EmulatorPool(const EmulatorPool&) = delete;
+        EmulatorPool& operator=(const EmulatorPool&) = delete;
+
+        //Takes an idle emulator and resets it to the ROM, preferring one that last ran the same ROM.
+        //A new emulator is only created if every emulator is in use
+        Handle Acquire(std::shared_ptr<const Rom> rom);
+
+        //Takes an idle emulator and forks it from a running one, see Emulator::ForkFrom().
+        //One that last ran the same ROM is preferred, as it has the least to invalidate
+        Handle Fork(const Emulator& parent);
+
+        std::size_t GetIdleCount() const;
+
+    private:
+        mutable std::mutex m_Mutex;
+
+        std::vector<std::unique_ptr<Emulator>> m_Idle;
+
+        //Takes an idle emulator, preferring one that last ran the given ROM, or creates a new one
+        std::unique_ptr<Emulator> Take(const std::shared_ptr<const Rom>& rom);
+
+        void Release(Emulator* emulator);
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Base.h"
+#include "Emulator/Display.h"
+#include "Emulator/Emulator.h"
+
+namespace CHIP8
+{
+    //A complete picture of the display, as it was at a timer tick
+    struct alignas(64) DisplayFrame
+    {
+        //Every plane, and the resolution it was drawn in
+        Display Screen;
+
+        //The timer tick it was published at, 0 before anything was published
+        std::uint64_t Tick = 0;
+    };
+
+    //Hands frames from the thread running the emulator to one renderer or encoder thread without ever locking.
+    //
+    //Three frames are kept: the writer fills the back one, the reader holds the front one, and the one in the middle
+    //is the latest complete frame. Publishing and taking a frame both swap with the middle one, so neither side ever
+    //waits or sees a frame that's being written. Frames the reader is too slow for are skipped
+    class FrameBuffer
+    {
+    public:
+        //Only called from the emulation thread, copies the display into the back frame and publishes it
+        void Publish(const Emulator& emulator, std::uint64_t tick)
+        {
+            DisplayFrame& frame = m_Frames[m_Back];
+            frame.Screen = emulator.GetDisplay();
+            frame.Tick = tick;
+
+            //The old middle frame is the reader's no more, so it's the next one to fill
+            m_Back = m_Middle.exchange(m_Back | Fresh, std::memory_order_acq_rel) & IndexMask;
+        }
+
+        //Only called from the reader thread. Takes the latest frame if one was published since the last call,
+        //returns false and keeps the current one otherwise
+        bool Acquire()
+        {
+            if ((m_Middle.load(std::memory_order_relaxed) & Fresh) == 0)
+            {
+                return false;
+            }
+
+            m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & IndexMask;
+
+            return true;
+        }
+
+        //Only called from the reader thread, stays untouched until the next Acquire()
+        const DisplayFrame& GetFrame() const { return m_Frames[m_Front]; }
+
+    private:
+        //Set in the middle index when the writer put a frame there the reader hasn't taken yet
+        static constexpr byte Fresh = 0x4;
+        static constexpr byte IndexMask = 0x3;
+
+        DisplayFrame m_Frames[3];
+
+        //Only ever touched by the writer and the reader respectively
+        byte m_Back = 0;
+        alignas(64) byte m_Front = 1;
+
+        alignas(64) std::atomic<byte> m_Middle{ 2 };
+    };
+}
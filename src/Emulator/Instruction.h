@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //An instruction that has already been split into its opcode and arguments
+    struct Instruction
+    {
+        //The first nibble, selects the handler of this instruction
+        byte OpCode = 0x0;
+
+        //X: The second nibble, used to look up one of the variable registers
+        byte X = 0x0;
+
+        //Y: The third nibble, used to look up one of the variable registers
+        byte Y = 0x0;
+
+        //N: The fourth nibble, an immediate 4-bit number
+        byte N = 0x0;
+
+        //NN: The second byte, an immediate 8-bit number
+        byte NN = 0x00;
+
+        //Whether or not this instruction has been decoded and can be used
+        bool Valid = false;
+
+        //NNN: The last three nibbles, an immediate 12-bit memory address
+        word NNN = 0x000;
+    };
+
+    //Splits a raw instruction into its opcode and arguments
+    constexpr Instruction Decode(word instruction)
+    {
+        return Instruction
+        {
+            (byte)((instruction >> 12) & 0xF),
+            (byte)((instruction >> 8) & 0xF),
+            (byte)((instruction >> 4) & 0xF),
+            (byte)(instruction & 0xF),
+            (byte)(instruction & 0xFF),
+            true,
+            (word)(instruction & 0xFFF)
+        };
+    }
+}
@@ -0,0 +1,460 @@
+#include "Emulator/JitCache.h"
+
+#include <cstddef>
+#include <initializer_list>
+
+#if defined(CHIP8_JIT_X64)
+    #if defined(_WIN32)
+        #include <windows.h>
+    #else
+        #include <sys/mman.h>
+    #endif
+#endif
+
+/*
+ * The compiled code keeps the guest state where the interpreter keeps it. For the whole block:
+ * - rbx points at the registers, so every variable register is at a fixed 8-bit displacement
+ * - r14 holds the emulator, which is handed back to the fallback for interpreted instructions
+ * - r15 points at the page table of the memory, one pointer per 256 bytes
+ *
+ * All three are callee-saved in both the System V and the Windows calling conventions, so they
+ * survive calls to the fallback. Instructions touching the display, the keypad, the timers, the
+ * stack or the random number generator are handed to the fallback instead of being translated.
+ */
+
+namespace CHIP8
+{
+    namespace
+    {
+        constexpr byte ProgramCounterOffset = offsetof(Registers, ProgramCounter);
+        constexpr byte IndexOffset = offsetof(Registers, Index);
+        constexpr byte VariableOffset = offsetof(Registers, Variable);
+
+        //Appends machine code to a buffer
+        class Emitter
+        {
+        public:
+            Emitter(byte* code)
+                : m_Code(code)
+            {
+            }
+
+            void Emit(std::initializer_list<byte> bytes)
+            {
+                for (byte value : bytes)
+                {
+                    m_Code[m_Size++] = value;
+                }
+            }
+
+            void Emit16(word value)
+            {
+                Emit({ (byte)(value & 0xFF), (byte)(value >> 8) });
+            }
+
+            void Emit64(std::uint64_t value)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    m_Code[m_Size++] = (byte)(value >> (i * 8));
+                }
+            }
+
+            std::size_t Size() const { return m_Size; }
+
+        private:
+            byte* m_Code = nullptr;
+            std::size_t m_Size = 0;
+        };
+
+        //Offset of VX from the registers
+        byte V(byte x) { return VariableOffset + x; }
+
+        void EmitPrologue(Emitter& code)
+        {
+            //push rbx, push r14, push r15 (this also realigns the stack to 16 bytes)
+            code.Emit({ 0x53, 0x41, 0x56, 0x41, 0x57 });
+
+        #if defined(_WIN32)
+            //Reserve the shadow space, then mov r14, rcx; mov rbx, rdx; mov r15, r8
+            code.Emit({ 0x48, 0x83, 0xEC, 0x20 });
+            code.Emit({ 0x49, 0x89, 0xCE, 0x48, 0x89, 0xD3, 0x4D, 0x89, 0xC7 });
+        #else
+            //mov r14, rdi; mov rbx, rsi; mov r15, rdx
+            code.Emit({ 0x49, 0x89, 0xFE, 0x48, 0x89, 0xF3, 0x49, 0x89, 0xD7 });
+        #endif
+        }
+
+        void EmitEpilogue(Emitter& code)
+        {
+        #if defined(_WIN32)
+            //Release the shadow space
+            code.Emit({ 0x48, 0x83, 0xC4, 0x20 });
+        #endif
+
+            //pop r15, pop r14, pop rbx, ret
+            code.Emit({ 0x41, 0x5F, 0x41, 0x5E, 0x5B, 0xC3 });
+        }
+
+        void EmitFallback(Emitter& code, JitFallback fallback, const Instruction* instruction)
+        {
+        #if defined(_WIN32)
+            //mov rcx, r14; mov rdx, instruction
+            code.Emit({ 0x4C, 0x89, 0xF1, 0x48, 0xBA });
+        #else
+            //mov rdi, r14; mov rsi, instruction
+            code.Emit({ 0x4C, 0x89, 0xF7, 0x48, 0xBE });
+        #endif
+            code.Emit64((std::uint64_t)instruction);
+
+            //mov rax, fallback; call rax
+            code.Emit({ 0x48, 0xB8 });
+            code.Emit64((std::uint64_t)fallback);
+            code.Emit({ 0xFF, 0xD0 });
+        }
+
+        //Increments the program counter by 2, skipped over by the preceding 5-byte conditional jump
+        void EmitSkip(Emitter& code, byte jump)
+        {
+            //jcc +5; add word [rbx + PC], 2
+            code.Emit({ jump, 0x05, 0x66, 0x83, 0x43, ProgramCounterOffset, 0x02 });
+        }
+
+        void EmitOpCode8(Emitter& code, const Instruction& instruction, const QuirkFlags& quirks)
+        {
+            byte vx = V(instruction.X);
+            byte vy = V(instruction.Y);
+            byte vf = V(0xF);
+
+            //The register shifted into VX
+            byte shifted = quirks.ShiftReadsVY ? vy : vx;
+
+            switch (instruction.N)
+            {
+                //LD VX, VY: mov al, [VY]; mov [VX], al
+                case 0x0: code.Emit({ 0x8A, 0x43, vy, 0x88, 0x43, vx }); break;
+
+                //OR VX, VY: mov al, [VY]; or [VX], al
+                case 0x1: code.Emit({ 0x8A, 0x43, vy, 0x08, 0x43, vx }); break;
+
+                //AND VX, VY: mov al, [VY]; and [VX], al
+                case 0x2: code.Emit({ 0x8A, 0x43, vy, 0x20, 0x43, vx }); break;
+
+                //XOR VX, VY: mov al, [VY]; xor [VX], al
+                case 0x3: code.Emit({ 0x8A, 0x43, vy, 0x30, 0x43, vx }); break;
+
+                //ADD VX, VY: mov al, [VX]; add al, [VY]; setc cl; mov [VF], cl; mov [VX], al
+                case 0x4:
+                {
+                    code.Emit({ 0x8A, 0x43, vx, 0x02, 0x43, vy, 0x0F, 0x92, 0xC1 });
+                    code.Emit({ 0x88, 0x4B, vf, 0x88, 0x43, vx });
+                    break;
+                }
+
+                //SUB VX, VY: mov al, [VX]; mov dl, [VY]; cmp al, dl; seta cl; sub al, dl; mov [VF], cl; mov [VX], al
+                case 0x5:
+                {
+                    code.Emit({ 0x8A, 0x43, vx, 0x8A, 0x53, vy, 0x38, 0xD0, 0x0F, 0x97, 0xC1, 0x28, 0xD0 });
+                    code.Emit({ 0x88, 0x4B, vf, 0x88, 0x43, vx });
+                    break;
+                }
+
+                //SHR VX {, VY}: mov al, [VX or VY]; mov cl, al; and cl, 1; shr al, 1; mov [VF], cl; mov [VX], al
+                case 0x6:
+                {
+                    code.Emit({ 0x8A, 0x43, shifted, 0x88, 0xC1, 0x80, 0xE1, 0x01, 0xD0, 0xE8 });
+                    code.Emit({ 0x88, 0x4B, vf, 0x88, 0x43, vx });
+                    break;
+                }
+
+                //SUBN VX, VY: mov al, [VY]; mov dl, [VX]; cmp al, dl; seta cl; sub al, dl; mov [VF], cl; mov [VX], al
+                case 0x7:
+                {
+                    code.Emit({ 0x8A, 0x43, vy, 0x8A, 0x53, vx, 0x38, 0xD0, 0x0F, 0x97, 0xC1, 0x28, 0xD0 });
+                    code.Emit({ 0x88, 0x4B, vf, 0x88, 0x43, vx });
+                    break;
+                }
+
+                //SHL VX {, VY}: mov al, [VX or VY]; mov cl, al; shr cl, 7; add al, al; mov [VF], cl; mov [VX], al
+                case 0xE:
+                {
+                    code.Emit({ 0x8A, 0x43, shifted, 0x88, 0xC1, 0xC0, 0xE9, 0x07, 0x00, 0xC0 });
+                    code.Emit({ 0x88, 0x4B, vf, 0x88, 0x43, vx });
+                    break;
+                }
+
+                //No known opcodes
+                default:
+                {
+                    break;
+                }
+            }
+
+            //The logic operations clear VF on the original interpreter: mov byte [VF], 0
+            if (quirks.LogicResetsVF && instruction.N >= 0x1 && instruction.N <= 0x3)
+            {
+                code.Emit({ 0xC6, 0x43, vf, 0x00 });
+            }
+        }
+
+        void EmitInstruction(Emitter& code, const Instruction& instruction, JitFallback fallback, const QuirkFlags& quirks)
+        {
+            byte vx = V(instruction.X);
+            byte vy = V(instruction.Y);
+
+            switch (instruction.OpCode)
+            {
+                //CLS, RET and the display instructions of SUPER-CHIP are interpreted, SYS addr is ignored
+                case 0x0:
+                {
+                    if (quirks.Extended || instruction.NNN == 0x0E0 || instruction.NNN == 0x0EE)
+                    {
+                        EmitFallback(code, fallback, &instruction);
+                    }
+
+                    break;
+                }
+
+                //JP addr: mov word [PC], NNN
+                case 0x1:
+                {
+                    code.Emit({ 0x66, 0xC7, 0x43, ProgramCounterOffset });
+                    code.Emit16(instruction.NNN);
+                    break;
+                }
+
+                //SE VX, byte: cmp byte [VX], NN; jne
+                case 0x3:
+                {
+                    code.Emit({ 0x80, 0x7B, vx, instruction.NN });
+                    EmitSkip(code, 0x75);
+                    break;
+                }
+
+                //SNE VX, byte: cmp byte [VX], NN; je
+                case 0x4:
+                {
+                    code.Emit({ 0x80, 0x7B, vx, instruction.NN });
+                    EmitSkip(code, 0x74);
+                    break;
+                }
+
+                //SE VX, VY: mov al, [VX]; cmp al, [VY]; jne
+                case 0x5:
+                {
+                    //The loads and stores of a range of registers of XO-CHIP are interpreted
+                    if (quirks.XoChip && instruction.N != 0x0)
+                    {
+                        EmitFallback(code, fallback, &instruction);
+                        break;
+                    }
+
+                    code.Emit({ 0x8A, 0x43, vx, 0x3A, 0x43, vy });
+                    EmitSkip(code, 0x75);
+                    break;
+                }
+
+                //LD VX, byte: mov byte [VX], NN
+                case 0x6:
+                {
+                    code.Emit({ 0xC6, 0x43, vx, instruction.NN });
+                    break;
+                }
+
+                //ADD VX, byte: add byte [VX], NN
+                case 0x7:
+                {
+                    code.Emit({ 0x80, 0x43, vx, instruction.NN });
+                    break;
+                }
+
+                case 0x8:
+                {
+                    EmitOpCode8(code, instruction, quirks);
+                    break;
+                }
+
+                //SNE VX, VY: mov al, [VX]; cmp al, [VY]; je
+                case 0x9:
+                {
+                    code.Emit({ 0x8A, 0x43, vx, 0x3A, 0x43, vy });
+                    EmitSkip(code, 0x74);
+                    break;
+                }
+
+                //LD I, addr: mov word [I], NNN
+                case 0xA:
+                {
+                    code.Emit({ 0x66, 0xC7, 0x43, IndexOffset });
+                    code.Emit16(instruction.NNN);
+                    break;
+                }
+
+                case 0xF:
+                {
+                    switch (instruction.NN)
+                    {
+                        //ADD I, VX: movzx eax, byte [VX]; add word [I], ax
+                        case 0x1E:
+                        {
+                            code.Emit({ 0x0F, 0xB6, 0x43, vx, 0x66, 0x01, 0x43, IndexOffset });
+                            break;
+                        }
+
+                        //LD F, VX: movzx eax, byte [VX]; lea eax, [rax + rax * 4]; mov word [I], ax
+                        case 0x29:
+                        {
+                            code.Emit({ 0x0F, 0xB6, 0x43, vx, 0x8D, 0x04, 0x80, 0x66, 0x89, 0x43, IndexOffset });
+                            break;
+                        }
+
+                        //LD VX, [I]
+                        case 0x65:
+                        {
+                            for (byte i = 0; i <= instruction.X; i++)
+                            {
+                                //movzx eax, word [I]; add eax, i; and eax, AddressMask
+                                code.Emit({ 0x0F, 0xB7, 0x43, IndexOffset, 0x83, 0xC0, i, 0x25 });
+                                code.Emit16(quirks.AddressMask);
+                                code.Emit16(0x0000);
+
+                                //mov ecx, eax; shr ecx, 8; mov rcx, [r15 + rcx * 8]; movzx eax, al; mov cl, [rcx + rax]; mov [VI], cl
+                                code.Emit({ 0x89, 0xC1, 0xC1, 0xE9, 0x08, 0x49, 0x8B, 0x0C, 0xCF });
+                                code.Emit({ 0x0F, 0xB6, 0xC0, 0x8A, 0x0C, 0x01, 0x88, 0x4B, V(i) });
+                            }
+
+                            //Leave I past the last register: add word [I], X + 1
+                            if (quirks.LoadStoreAdvancesIndex)
+                            {
+                                code.Emit({ 0x66, 0x83, 0x43, IndexOffset, (byte)(instruction.X + 1) });
+                            }
+
+                            break;
+                        }
+
+                        //The timers, the keypad and the stores to memory are interpreted
+                        default:
+                        {
+                            EmitFallback(code, fallback, &instruction);
+                            break;
+                        }
+                    }
+
+                    break;
+                }
+
+                //CALL addr, JP V0, addr, RND VX, byte, DRW VX, VY, nibble, SKP VX and SKNP VX are interpreted
+                default:
+                {
+                    EmitFallback(code, fallback, &instruction);
+                    break;
+                }
+            }
+        }
+    }
+
+    JitCache::JitCache(JitFallback fallback, const QuirkFlags& quirks)
+        : m_Fallback(fallback), m_Quirks(quirks)
+    {
+    #if defined(CHIP8_JIT_X64)
+        #if defined(_WIN32)
+            m_Code = (byte*)VirtualAlloc(nullptr, CodeBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        #else
+            void* code = mmap(nullptr, CodeBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            m_Code = code == MAP_FAILED ? nullptr : (byte*)code;
+        #endif
+    #endif
+    }
+
+    JitCache::~JitCache()
+    {
+        if (!m_Code)
+        {
+            return;
+        }
+
+    #if defined(CHIP8_JIT_X64)
+        #if defined(_WIN32)
+            VirtualFree(m_Code, 0, MEM_RELEASE);
+        #else
+            munmap(m_Code, CodeBufferSize);
+        #endif
+    #endif
+    }
+
+    bool JitCache::Protect(bool writable)
+    {
+    #if defined(CHIP8_JIT_X64)
+        #if defined(_WIN32)
+            DWORD previous;
+            return VirtualProtect(m_Code, CodeBufferSize, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &previous) != 0;
+        #else
+            return mprotect(m_Code, CodeBufferSize, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+        #endif
+    #else
+        return false;
+    #endif
+    }
+
+    bool JitCache::IsSupported()
+    {
+    #if defined(CHIP8_JIT_X64)
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    void JitCache::Compile(BlockCache& blocks, Block& block)
+    {
+        //Without a code buffer the block just stays interpreted
+        if (!m_Code)
+        {
+            return;
+        }
+
+        //Start over once the code buffer cannot hold another block, every block has to be retranslated
+        if (m_CodeSize + MaximumBlockCodeSize > CodeBufferSize)
+        {
+            m_CodeSize = 0;
+            blocks.Flush();
+            return;
+        }
+
+        //The buffer is only ever writable or executable, never both. A host that refuses either keeps interpreting
+        if (!Protect(true))
+        {
+            return;
+        }
+
+        Emitter code(m_Code + m_CodeSize);
+        EmitPrologue(code);
+
+        const Instruction* instructions = blocks.Operations(block);
+
+        for (byte i = 0; i < block.Length; i++)
+        {
+            //A skip that is looked up might skip F000 NNNN, which only the interpreter knows the length of
+            if (m_Quirks.XoChip && block.Successors == 0 && i + 1 == block.Length)
+            {
+                EmitFallback(code, m_Fallback, &instructions[i]);
+                continue;
+            }
+
+            EmitInstruction(code, instructions[i], m_Fallback, m_Quirks);
+        }
+
+        EmitEpilogue(code);
+
+        //Code that can't run anymore can't be called either
+        if (!Protect(false))
+        {
+            m_CodeSize = 0;
+            blocks.Flush();
+            return;
+        }
+
+        block.Native = reinterpret_cast<NativeBlock>(m_Code + m_CodeSize);
+        m_CodeSize += code.Size();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Base.h"
+#include "Emulator/BlockCache.h"
+#include "Emulator/Quirks.h"
+
+//Native code can only be generated for x86-64 hosts
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CHIP8_JIT_X64
+#endif
+
+namespace CHIP8
+{
+    //Called by compiled code to interpret the instructions it doesn't translate itself
+    using JitFallback = void (*)(void* context, const Instruction* instruction);
+
+    //Compiles hot blocks into native x86-64 code
+    class JitCache
+    {
+    public:
+        //The number of times a block has to be interpreted before it gets compiled
+        static constexpr word CompileThreshold = 16;
+
+        //The fallback has to interpret with the same quirks the code is compiled for
+        JitCache(JitFallback fallback, const QuirkFlags& quirks);
+        ~JitCache();
+
+        JitCache(const JitCache&) = delete;
+        JitCache& operator=(const JitCache&) = delete;
+
+        //Whether or not native code can be generated on this host
+        static bool IsSupported();
+
+        //Compiles the given block, flushing every block once the code buffer is full
+        void Compile(BlockCache& blocks, Block& block);
+
+    private:
+        static constexpr std::size_t CodeBufferSize = 0x40000;
+
+        //The largest amount of code a single block can compile to
+        static constexpr std::size_t MaximumBlockCodeSize = BlockCache::MaximumBlockLength * 0x200 + 0x40;
+
+        byte* m_Code = nullptr;
+        std::size_t m_CodeSize = 0;
+
+        JitFallback m_Fallback = nullptr;
+        QuirkFlags m_Quirks;
+
+        //Switches the code buffer between writable while compiling and executable otherwise, returns false on failure
+        bool Protect(bool writable);
+    };
+}
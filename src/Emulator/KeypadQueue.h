@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //A key pressed or released, once the given number of instructions have executed
+    struct KeyEvent
+    {
+        std::uint64_t Cycle = 0;
+        byte Key = 0x0;
+        bool Pressed = false;
+    };
+
+    //Hands key events from one host input thread to the thread running the emulator without ever locking.
+    //Neither side waits for the other, a full queue drops the event instead.
+    //
+    //The host can't know which instruction the emulator is at, so events carry no cycle when pushed.
+    //The Scheduler stamps them with the cycle they take effect at, which is what a replay needs
+    class KeypadQueue
+    {
+    public:
+        //A power of two, far more events than anyone can type in a frame
+        static constexpr std::size_t Capacity = 256;
+
+        //Only called from the host input thread, returns false if the queue is full
+        bool Push(byte key, bool pressed)
+        {
+            std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+
+            if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+
+            m_Events[tail & (Capacity - 1)] = (byte)((key & 0xF) | (pressed << 4));
+
+            //Publishes the event to the consumer
+            m_Tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        //Only called from the emulation thread, returns false if the queue is empty
+        bool Pop(byte& key, bool& pressed)
+        {
+            std::size_t head = m_Head.load(std::memory_order_relaxed);
+
+            if (head == m_Tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            byte event = m_Events[head & (Capacity - 1)];
+            key = event & 0xF;
+            pressed = (event >> 4) & 0x1;
+
+            //Hands the slot back to the producer
+            m_Head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+    private:
+        //The key in the low nibble, whether it went down in bit 4
+        byte m_Events[Capacity] = { 0 };
+
+        //Each index is written by one side only, on its own cache line so the sides don't slow each other down
+        alignas(64) std::atomic<std::size_t> m_Head{ 0 };
+        alignas(64) std::atomic<std::size_t> m_Tail{ 0 };
+    };
+}
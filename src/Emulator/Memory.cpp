@@ -0,0 +1,141 @@
+#include "Emulator/Memory.h"
+
+#include <cstring>
+
+namespace CHIP8
+{
+    //Counted as 0 users, so it never looks like a page of its own
+    Memory::Page Memory::s_Blank{ { 0 }, { 0 } };
+
+    Memory::Memory()
+    {
+        for (std::size_t page = 0; page < PageCount; page++)
+        {
+            m_Pages[page] = &s_Blank;
+            m_Data[page] = s_Blank.Data;
+        }
+    }
+
+    Memory::~Memory()
+    {
+        for (Page* page : m_Pages)
+        {
+            Release(page);
+        }
+    }
+
+    Memory::Memory(const Memory& other)
+    {
+        for (std::size_t page = 0; page < PageCount; page++)
+        {
+            m_Pages[page] = other.m_Pages[page];
+            Acquire(m_Pages[page]);
+            m_Data[page] = m_Pages[page]->Data;
+        }
+    }
+
+    Memory& Memory::operator=(const Memory& other)
+    {
+        for (std::size_t page = 0; page < PageCount; page++)
+        {
+            //Sharing the same page already, also covers assigning to itself
+            if (m_Pages[page] == other.m_Pages[page])
+            {
+                continue;
+            }
+
+            Acquire(other.m_Pages[page]);
+            Release(m_Pages[page]);
+
+            m_Pages[page] = other.m_Pages[page];
+            m_Data[page] = m_Pages[page]->Data;
+        }
+
+        return *this;
+    }
+
+    void Memory::Load(const byte* data)
+    {
+        for (std::size_t page = 0; page < PageCount; page++)
+        {
+            const byte* source = &data[page * PageSize];
+
+            //Blank pages go back to sharing the blank page
+            if (memcmp(source, s_Blank.Data, PageSize) == 0)
+            {
+                Release(m_Pages[page]);
+
+                m_Pages[page] = &s_Blank;
+                m_Data[page] = s_Blank.Data;
+                continue;
+            }
+
+            if (m_Pages[page]->References.load(std::memory_order_acquire) != 1)
+            {
+                Release(m_Pages[page]);
+
+                m_Pages[page] = Allocate();
+                m_Data[page] = m_Pages[page]->Data;
+            }
+
+            memcpy(m_Data[page], source, PageSize);
+        }
+    }
+
+    void Memory::Store(byte* data) const
+    {
+        for (std::size_t page = 0; page < PageCount; page++)
+        {
+            memcpy(&data[page * PageSize], m_Data[page], PageSize);
+        }
+    }
+
+    bool Memory::Matches(word address, const byte* data, std::size_t size) const
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            if (Read((address + i) & 0xFFF) != data[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Memory::Unshare(byte page)
+    {
+        Page* copy = Allocate();
+        memcpy(copy->Data, m_Data[page], PageSize);
+
+        Release(m_Pages[page]);
+
+        m_Pages[page] = copy;
+        m_Data[page] = copy->Data;
+    }
+
+    void Memory::Acquire(Page* page)
+    {
+        if (page != &s_Blank)
+        {
+            page->References.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Memory::Page* Memory::Allocate()
+    {
+        Page* page = new Page;
+        page->References.store(1, std::memory_order_relaxed);
+
+        return page;
+    }
+
+    void Memory::Release(Page* page)
+    {
+        //The last memory using a page frees it
+        if (page != &s_Blank && page->References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete page;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //The 64 KB of memory XO-CHIP can address, split into pages of 256 bytes. Copies share every page until one of them
+    //writes to it, only then does the writer get a page of its own.
+    //
+    //Programs only ever run from the first 4 KB, which is all the other variants can address. Every page that is still
+    //blank shares a single static page, so the rest of memory costs nothing until an XO-CHIP program writes to it
+    class Memory
+    {
+    public:
+        static constexpr std::size_t Size = 0xFFFF + 1;
+        static constexpr std::size_t PageSize = 0x100;
+        static constexpr std::size_t PageCount = Size / PageSize;
+
+        //The pages instructions can be fetched from
+        static constexpr std::size_t CodePageCount = (0xFFF + 1) / PageSize;
+
+        Memory();
+        ~Memory();
+
+        //Copies share every page
+        Memory(const Memory& other);
+        Memory& operator=(const Memory& other);
+
+        //The address has to be within memory
+        byte Read(word address) const { return m_Data[address >> 8][address & 0xFF]; }
+
+        //Copies the page first if it is shared, the address has to be within memory
+        void Write(word address, byte value)
+        {
+            if (m_Pages[address >> 8]->References.load(std::memory_order_acquire) != 1)
+            {
+                Unshare(address >> 8);
+            }
+
+            m_Data[address >> 8][address & 0xFF] = value;
+        }
+
+        //Overwrites all of memory
+        void Load(const byte* data);
+
+        //Copies all of memory out
+        void Store(byte* data) const;
+
+        //Whether the bytes at the address are the same as the given ones, wrapping around the end of memory
+        bool Matches(word address, const byte* data, std::size_t size) const;
+
+        //Whether both memories share the given page, which means it holds the same bytes in both
+        bool Shares(const Memory& other, byte page) const { return m_Pages[page] == other.m_Pages[page]; }
+
+        const byte* GetPage(byte page) const { return m_Data[page]; }
+
+        //One pointer per page, this is how translated and compiled code sees memory
+        const byte* const* GetPages() const { return m_Data; }
+
+    private:
+        struct Page
+        {
+            //The number of memories sharing this page
+            std::atomic<std::uint32_t> References;
+
+            byte Data[PageSize];
+        };
+
+        Page* m_Pages[PageCount];
+
+        //The data of every page, kept next to each other so reading only takes one extra load
+        byte* m_Data[PageCount];
+
+        //Shared by every blank page, never counted and never freed. Writing to it always makes a copy first
+        static Page s_Blank;
+
+        //Gives this memory its own copy of a shared page
+        void Unshare(byte page);
+
+        static Page* Allocate();
+        static void Acquire(Page* page);
+        static void Release(Page* page);
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Base.h"
+#include "Emulator/Font.h"
+
+namespace CHIP8
+{
+    //The contents of memory right after a reset, restored with a single copy
+    struct MemoryImage
+    {
+        static constexpr word ProgramStart = 0x200;
+
+        //All of the 64 KB of XO-CHIP, the other variants only see the first 4 KB
+        byte Memory[0xFFFF + 1];
+
+        //Only the fonts, built at compile time
+        constexpr MemoryImage()
+            : Memory{}
+        {
+            for (word i = 0; i < sizeof(Font); i++)
+            {
+                Memory[i] = Font[i];
+            }
+
+            for (word i = 0; i < sizeof(BigFont); i++)
+            {
+                Memory[BigFontAddress + i] = BigFont[i];
+            }
+        }
+    };
+
+    //The memory of an emulator without a program
+    constexpr MemoryImage InitialImage{};
+}
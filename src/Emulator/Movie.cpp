@@ -0,0 +1,206 @@
+#include "Emulator/Movie.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace CHIP8
+{
+    namespace
+    {
+        const char MovieMagic[4] = { 'C', '8', 'M', 'V' };
+
+        void WriteInteger(std::vector<byte>& data, std::uint64_t value, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; i++)
+            {
+                data.push_back((byte)(value >> (i * 8)));
+            }
+        }
+
+        //Seven bits at a time, the top bit is set on every byte but the last
+        void WriteVarint(std::vector<byte>& data, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                data.push_back((byte)(value | 0x80));
+                value >>= 7;
+            }
+
+            data.push_back((byte)value);
+        }
+
+        //Reads forward through the data, every read past the end fails and leaves the value at zero
+        class MovieReader
+        {
+        public:
+            MovieReader(const byte* data, std::size_t size)
+                : m_Data(data), m_Size(size)
+            {
+            }
+
+            bool ReadInteger(std::uint64_t& value, std::size_t size)
+            {
+                value = 0;
+
+                if (m_Size - m_Offset < size)
+                {
+                    return false;
+                }
+
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    value |= std::uint64_t(m_Data[m_Offset++]) << (i * 8);
+                }
+
+                return true;
+            }
+
+            bool ReadVarint(std::uint64_t& value)
+            {
+                value = 0;
+
+                for (unsigned shift = 0; shift < 64 && m_Offset < m_Size; shift += 7)
+                {
+                    byte next = m_Data[m_Offset++];
+                    value |= std::uint64_t(next & 0x7F) << shift;
+
+                    if ((next & 0x80) == 0)
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            std::size_t GetRemaining() const { return m_Size - m_Offset; }
+
+        private:
+            const byte* m_Data;
+            std::size_t m_Size;
+            std::size_t m_Offset = 0;
+        };
+    }
+
+    std::vector<byte> Movie::Serialize() const
+    {
+        std::vector<byte> data(MovieMagic, MovieMagic + sizeof(MovieMagic));
+        data.reserve(48 + Events.size() * 3);
+
+        WriteInteger(data, Version, 2);
+        WriteInteger(data, RomHash, 8);
+        WriteInteger(data, Seed, 4);
+        WriteInteger(data, ClockSpeed, 4);
+        WriteInteger(data, (std::uint32_t)Quirks, 4);
+        WriteInteger(data, Cycles, 8);
+        WriteInteger(data, Events.size(), 4);
+
+        std::uint64_t cycle = 0;
+
+        for (const KeyEvent& event : Events)
+        {
+            WriteVarint(data, event.Cycle - cycle);
+            data.push_back((byte)((event.Key & 0xF) | (event.Pressed << 4)));
+
+            cycle = event.Cycle;
+        }
+
+        return data;
+    }
+
+    bool Movie::Deserialize(const byte* data, std::size_t size, std::string& error)
+    {
+        if (size < sizeof(MovieMagic) || memcmp(data, MovieMagic, sizeof(MovieMagic)) != 0)
+        {
+            error = "not a movie";
+            return false;
+        }
+
+        MovieReader reader(data + sizeof(MovieMagic), size - sizeof(MovieMagic));
+        std::uint64_t version, seed, clockSpeed, quirks, count;
+
+        if (!reader.ReadInteger(version, 2) || version != Version)
+        {
+            error = "unsupported movie version " + std::to_string(version);
+            return false;
+        }
+
+        if (!reader.ReadInteger(RomHash, 8) || !reader.ReadInteger(seed, 4) || !reader.ReadInteger(clockSpeed, 4) ||
+            !reader.ReadInteger(quirks, 4) || !reader.ReadInteger(Cycles, 8) || !reader.ReadInteger(count, 4))
+        {
+            error = "truncated movie header";
+            return false;
+        }
+
+        if (quirks > (std::uint64_t)QuirkProfile::XoChip)
+        {
+            error = "recorded with quirks this build doesn't have";
+            return false;
+        }
+
+        Seed = (std::uint32_t)seed;
+        ClockSpeed = (std::uint32_t)clockSpeed;
+        Quirks = (QuirkProfile)quirks;
+
+        //Every event takes at least two bytes, so a bogus count can't allocate much
+        if (count > reader.GetRemaining() / 2)
+        {
+            error = "truncated movie events";
+            return false;
+        }
+
+        Events.assign(count, KeyEvent());
+        std::uint64_t cycle = 0;
+
+        for (KeyEvent& event : Events)
+        {
+            std::uint64_t delta, key;
+
+            if (!reader.ReadVarint(delta) || !reader.ReadInteger(key, 1) || key > 0x1F)
+            {
+                error = "truncated movie events";
+                return false;
+            }
+
+            cycle += delta;
+
+            event.Cycle = cycle;
+            event.Key = key & 0xF;
+            event.Pressed = (key >> 4) & 0x1;
+        }
+
+        return true;
+    }
+
+    bool Movie::Save(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        std::vector<byte> data = Serialize();
+
+        file.write((const char*)data.data(), data.size());
+
+        return (bool)file;
+    }
+
+    bool Movie::Load(const std::string& path, std::string& error)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::vector<byte> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (!Deserialize(data.data(), data.size(), error))
+        {
+            error = path + ": " + error;
+            return false;
+        }
+
+        return true;
+    }
+}
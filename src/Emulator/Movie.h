@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/KeypadQueue.h"
+#include "Emulator/Quirks.h"
+#include "Emulator/Scheduler.h"
+
+namespace CHIP8
+{
+    //Everything needed to play a run again exactly: the ROM, the seed, the clock speed and every change of the keypad,
+    //stamped with the cycle it took effect at.
+    //
+    //Stored little-endian: the magic and version, the header fields, the event count, then every event as the cycles
+    //since the previous event in LEB128 followed by a byte with the key in the low nibble and whether it went down in bit 4
+    struct Movie
+    {
+        //The version written by Save(), movies of other versions are rejected
+        static constexpr word Version = 1;
+
+        //The hash of the ROM it was recorded with, see Rom::GetHash()
+        std::uint64_t RomHash = 0;
+
+        std::uint32_t Seed = 0;
+        std::uint32_t ClockSpeed = Scheduler::DefaultClockSpeed;
+
+        //The quirk profile it was played with, stored as 4 bytes
+        QuirkProfile Quirks = QuirkProfile::Modern;
+
+        //The instructions the run lasted
+        std::uint64_t Cycles = 0;
+
+        //Sorted by cycle
+        std::vector<KeyEvent> Events;
+
+        std::vector<byte> Serialize() const;
+
+        //Returns false and describes the problem if the data isn't a movie this build can play
+        bool Deserialize(const byte* data, std::size_t size, std::string& error);
+
+        bool Save(const std::string& path) const;
+        bool Load(const std::string& path, std::string& error);
+    };
+}
@@ -0,0 +1,157 @@
+#include "Emulator/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Writes an address the way the instructions name it, like 0x2A4
+        void WriteAddress(std::ostream& output, word address)
+        {
+            output << "0x" << std::hex << std::uppercase << std::setw(3) << std::setfill('0') << address << std::dec << std::nouppercase << std::setfill(' ');
+        }
+    }
+
+    Profiler::Profiler()
+    {
+        Reset();
+    }
+
+    void Profiler::Reset()
+    {
+        for (Handler& handler : m_Handlers)
+        {
+            handler = Handler();
+        }
+
+        memset(m_Hits, 0, sizeof(m_Hits));
+    }
+
+    void Profiler::Merge(const Profiler& other)
+    {
+        for (word index = 0; index <= 0xFFF; index++)
+        {
+            m_Handlers[index].Count += other.m_Handlers[index].Count;
+            m_Handlers[index].Cycles += other.m_Handlers[index].Cycles;
+            m_Hits[index] += other.m_Hits[index];
+        }
+    }
+
+    void Profiler::WriteName(std::ostream& output, word index)
+    {
+        static const char* const patterns[0xF + 1] =
+        {
+            "0NNN", "1NNN", "2NNN", "3XNN", "4XNN", "5XY", "6XNN", "7XNN",
+            "8XY", "9XY0", "ANNN", "BNNN", "CXNN", "DXYN", "EX", "FX"
+        };
+
+        byte opCode = index >> 8;
+        byte sub = index & 0xFF;
+
+        output << std::hex << std::uppercase;
+
+        switch (opCode)
+        {
+            //CLS, RET, the scrolls and the other SUPER-CHIP instructions, every other 0NNN is SYS addr
+            case 0x0:
+            {
+                if (sub == 0xC0 || sub == 0xD0)
+                {
+                    output << "00" << (unsigned)(sub >> 4) << 'N';
+                }
+                else if (sub != 0x00)
+                {
+                    output << "00" << (unsigned)sub;
+                }
+                else
+                {
+                    output << patterns[opCode];
+                }
+
+                break;
+            }
+
+            case 0x5:
+            case 0x8: output << patterns[opCode] << (unsigned)sub; break;
+            case 0xE:
+            case 0xF: output << patterns[opCode] << std::setw(2) << std::setfill('0') << (unsigned)sub; break;
+            default: output << patterns[opCode]; break;
+        }
+
+        output << std::dec << std::nouppercase << std::setfill(' ');
+    }
+
+    void Profiler::WriteJson(std::ostream& output) const
+    {
+        std::vector<word> handlers;
+        std::vector<word> addresses;
+
+        for (word index = 0; index <= 0xFFF; index++)
+        {
+            if (m_Handlers[index].Count > 0)
+            {
+                handlers.push_back(index);
+            }
+
+            if (m_Hits[index] > 0)
+            {
+                addresses.push_back(index);
+            }
+        }
+
+        //The most expensive handlers and the hottest addresses first
+        std::stable_sort(handlers.begin(), handlers.end(), [this](word a, word b) { return m_Handlers[a].Cycles > m_Handlers[b].Cycles; });
+        std::stable_sort(addresses.begin(), addresses.end(), [this](word a, word b) { return m_Hits[a] > m_Hits[b]; });
+
+        output << "{\n  \"handlers\": [";
+
+        for (std::size_t i = 0; i < handlers.size(); i++)
+        {
+            const Handler& handler = m_Handlers[handlers[i]];
+
+            output << (i == 0 ? "\n" : ",\n") << "    { \"handler\": \"";
+            WriteName(output, handlers[i]);
+            output << "\", \"count\": " << handler.Count << ", \"host_cycles\": " << handler.Cycles << " }";
+        }
+
+        output << "\n  ],\n  \"addresses\": [";
+
+        for (std::size_t i = 0; i < addresses.size(); i++)
+        {
+            output << (i == 0 ? "\n" : ",\n") << "    { \"address\": \"";
+            WriteAddress(output, addresses[i]);
+            output << "\", \"count\": " << m_Hits[addresses[i]] << " }";
+        }
+
+        output << "\n  ]\n}\n";
+    }
+
+    void Profiler::WriteCsv(std::ostream& output) const
+    {
+        output << "kind,name,count,host_cycles\n";
+
+        for (word index = 0; index <= 0xFFF; index++)
+        {
+            if (m_Handlers[index].Count > 0)
+            {
+                output << "handler,";
+                WriteName(output, index);
+                output << ',' << m_Handlers[index].Count << ',' << m_Handlers[index].Cycles << '\n';
+            }
+        }
+
+        for (word address = 0; address <= 0xFFF; address++)
+        {
+            if (m_Hits[address] > 0)
+            {
+                output << "address,";
+                WriteAddress(output, address);
+                output << ',' << m_Hits[address] << ",\n";
+            }
+        }
+    }
+}
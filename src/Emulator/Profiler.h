@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "Base.h"
+#include "Emulator/Instruction.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define CHIP8_PROFILER_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define CHIP8_PROFILER_RDTSC
+#else
+    #include <chrono>
+#endif
+
+namespace CHIP8
+{
+    //Counts how often every handler runs and the host cycles it takes, and how often every address is executed.
+    //Handlers are told apart down to the sub-opcodes of 0, 5, 8, E and F, so 8XY4 and 8XY5 are counted separately
+    class Profiler
+    {
+    public:
+        static constexpr bool Enabled = true;
+
+        Profiler();
+
+        //A host timestamp, taken right before an instruction runs
+        std::uint64_t Begin() const { return Now(); }
+
+        //Counts an instruction that ran from the given address, starting at the given timestamp
+        void End(const Instruction& instruction, word address, std::uint64_t start)
+        {
+            Handler& handler = m_Handlers[HandlerIndex(instruction)];
+            handler.Count++;
+            handler.Cycles += Now() - start;
+
+            m_Hits[address]++;
+        }
+
+        //Clears every count
+        void Reset();
+
+        //Adds the counts of another profile to this one
+        void Merge(const Profiler& other);
+
+        //Writes the handlers sorted by the host cycles spent in them, then the addresses sorted by their hits.
+        //Only handlers and addresses that ran are written
+        void WriteJson(std::ostream& output) const;
+
+        //Writes one line per handler, then one line per address, in the order of their opcodes and addresses
+        void WriteCsv(std::ostream& output) const;
+
+        //The number of times instructions were executed from the given address
+        std::uint64_t GetHits(word address) const { return m_Hits[address & 0xFFF]; }
+
+    private:
+        struct Handler
+        {
+            std::uint64_t Count = 0;
+            std::uint64_t Cycles = 0;
+        };
+
+        //One entry per opcode and sub-opcode, see HandlerIndex()
+        Handler m_Handlers[0xFFF + 1];
+
+        std::uint64_t m_Hits[0xFFF + 1];
+
+        //The opcode in the high nibble and the sub-opcode that picks the handler in the low byte
+        static word HandlerIndex(const Instruction& instruction)
+        {
+            switch (instruction.OpCode)
+            {
+                case 0x0: return instruction.X != 0x0 ? 0x00 : HandlerIndex0(instruction.NN);
+                case 0x5: return 0x500 | instruction.N;
+                case 0x8: return 0x800 | instruction.N;
+                case 0xE: return 0xE00 | instruction.NN;
+                case 0xF: return 0xF00 | instruction.NN;
+                default: return (word)instruction.OpCode << 8;
+            }
+        }
+
+        //CLS, RET and the SUPER-CHIP instructions by their low byte, the scrolls by rows share one handler each.
+        //Everything else is SYS addr
+        static word HandlerIndex0(byte nn)
+        {
+            if (nn == 0xE0 || nn == 0xEE || nn >= 0xFB)
+            {
+                return nn;
+            }
+
+            return (nn & 0xF0) == 0xC0 || (nn & 0xF0) == 0xD0 ? nn & 0xF0 : 0x00;
+        }
+
+        //The name of the instruction a handler runs, like 8XY4
+        static void WriteName(std::ostream& output, word index);
+
+        //Host cycles on x86, nanoseconds everywhere else
+        static std::uint64_t Now()
+        {
+#if defined(CHIP8_PROFILER_RDTSC)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+    };
+
+    //Stands in for the profiler when it isn't compiled in, every call compiles down to nothing
+    class NullProfiler
+    {
+    public:
+        static constexpr bool Enabled = false;
+
+        std::uint64_t Begin() const { return 0; }
+        void End(const Instruction&, word, std::uint64_t) {}
+
+        void Reset() {}
+        void Merge(const NullProfiler&) {}
+
+        void WriteJson(std::ostream&) const {}
+        void WriteCsv(std::ostream&) const {}
+
+        std::uint64_t GetHits(word) const { return 0; }
+    };
+
+    //The profiler used by the emulator, selected at build time with CHIP8_ENABLE_PROFILER
+#if defined(CHIP8_PROFILE)
+    using ExecutionProfiler = Profiler;
+#else
+    using ExecutionProfiler = NullProfiler;
+#endif
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //The variants of CHIP-8 a ROM can be written for, they differ in a few instructions
+    enum class QuirkProfile : byte
+    {
+        //Shifts VX in place, leaves I alone on loads and stores, jumps from V0, wraps sprites and keeps VF on logic
+        Modern,
+
+        //The original interpreter: shifts VY into VX, advances I on loads and stores, clips sprites and resets VF on logic
+        CosmacVip,
+
+        //SUPER-CHIP 1.1: like modern, but jumps from VX and clips sprites. Adds the high resolution and scrolling
+        SuperChip,
+
+        //XO-CHIP: like the original interpreter, but wraps sprites and keeps VF on logic. Adds everything SUPER-CHIP does,
+        //64 KB of memory and a second bitplane
+        XoChip
+    };
+
+    //The behaviors of a profile as compile-time constants, the handlers are specialized on one of these
+    //so every profile gets its own code without checking a flag per instruction
+    struct ModernQuirks
+    {
+        static constexpr QuirkProfile Profile = QuirkProfile::Modern;
+
+        //SHR VX, VY and SHL VX, VY shift VY into VX instead of shifting VX in place
+        static constexpr bool ShiftReadsVY = false;
+
+        //LD [I], VX and LD VX, [I] leave I pointing past the last register
+        static constexpr bool LoadStoreAdvancesIndex = false;
+
+        //JP V0, addr adds VX, with X the top nibble of the address, instead of V0
+        static constexpr bool JumpAddsVX = false;
+
+        //Sprites are cut off at the edges of the display instead of wrapping around
+        static constexpr bool ClipSprites = false;
+
+        //OR, AND and XOR reset VF
+        static constexpr bool LogicResetsVF = false;
+
+        //The SUPER-CHIP instructions: high resolution, scrolling, 16x16 sprites, the big font and the user flags
+        static constexpr bool Extended = false;
+
+        //The XO-CHIP instructions on top of those: bitplanes, long loads of I, loads and stores of register ranges and audio
+        static constexpr bool XoChip = false;
+
+        //Loads and stores through I reach 4 KB, or all of the 64 KB of XO-CHIP
+        static constexpr word AddressMask = 0xFFF;
+    };
+
+    struct CosmacVipQuirks
+    {
+        static constexpr QuirkProfile Profile = QuirkProfile::CosmacVip;
+        static constexpr bool ShiftReadsVY = true;
+        static constexpr bool LoadStoreAdvancesIndex = true;
+        static constexpr bool JumpAddsVX = false;
+        static constexpr bool ClipSprites = true;
+        static constexpr bool LogicResetsVF = true;
+        static constexpr bool Extended = false;
+        static constexpr bool XoChip = false;
+        static constexpr word AddressMask = 0xFFF;
+    };
+
+    struct SuperChipQuirks
+    {
+        static constexpr QuirkProfile Profile = QuirkProfile::SuperChip;
+        static constexpr bool ShiftReadsVY = false;
+        static constexpr bool LoadStoreAdvancesIndex = false;
+        static constexpr bool JumpAddsVX = true;
+        static constexpr bool ClipSprites = true;
+        static constexpr bool LogicResetsVF = false;
+        static constexpr bool Extended = true;
+        static constexpr bool XoChip = false;
+        static constexpr word AddressMask = 0xFFF;
+    };
+
+    struct XoChipQuirks
+    {
+        static constexpr QuirkProfile Profile = QuirkProfile::XoChip;
+        static constexpr bool ShiftReadsVY = true;
+        static constexpr bool LoadStoreAdvancesIndex = true;
+        static constexpr bool JumpAddsVX = false;
+        static constexpr bool ClipSprites = false;
+        static constexpr bool LogicResetsVF = false;
+        static constexpr bool Extended = true;
+        static constexpr bool XoChip = true;
+        static constexpr word AddressMask = 0xFFFF;
+    };
+
+    //The same behaviors at runtime, for code generators that only look at them while generating
+    struct QuirkFlags
+    {
+        bool ShiftReadsVY = false;
+        bool LoadStoreAdvancesIndex = false;
+        bool JumpAddsVX = false;
+        bool ClipSprites = false;
+        bool LogicResetsVF = false;
+        bool Extended = false;
+        bool XoChip = false;
+        word AddressMask = 0xFFF;
+
+        template<typename Quirks>
+        static constexpr QuirkFlags Of()
+        {
+            return { Quirks::ShiftReadsVY, Quirks::LoadStoreAdvancesIndex, Quirks::JumpAddsVX, Quirks::ClipSprites, Quirks::LogicResetsVF,
+                Quirks::Extended, Quirks::XoChip, Quirks::AddressMask };
+        }
+
+        static QuirkFlags Of(QuirkProfile profile)
+        {
+            switch (profile)
+            {
+                case QuirkProfile::CosmacVip: return Of<CosmacVipQuirks>();
+                case QuirkProfile::SuperChip: return Of<SuperChipQuirks>();
+                case QuirkProfile::XoChip: return Of<XoChipQuirks>();
+                default: return Of<ModernQuirks>();
+            }
+        }
+    };
+
+    //The names used on the command line, in manifests and in generated code
+    inline const char* GetQuirkProfileName(QuirkProfile profile)
+    {
+        switch (profile)
+        {
+            case QuirkProfile::CosmacVip: return "vip";
+            case QuirkProfile::SuperChip: return "schip";
+            case QuirkProfile::XoChip: return "xochip";
+            default: return "modern";
+        }
+    }
+
+    //Returns false if the name isn't one of a profile
+    inline bool ParseQuirkProfile(const char* name, QuirkProfile& profile)
+    {
+        for (QuirkProfile candidate : { QuirkProfile::Modern, QuirkProfile::CosmacVip, QuirkProfile::SuperChip, QuirkProfile::XoChip })
+        {
+            if (strcmp(name, GetQuirkProfileName(candidate)) == 0)
+            {
+                profile = candidate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
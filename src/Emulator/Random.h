@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //The xorshift generator behind RND. Its whole state is one word, so it can be saved and restored with the machine
+    struct Random
+    {
+        std::uint32_t State = 1;
+
+        Random(std::uint32_t seed = 0)
+        {
+            Seed(seed);
+        }
+
+        void Seed(std::uint32_t seed)
+        {
+            //Scramble the seed so nearby seeds don't start out with nearby sequences
+            seed = (seed ^ (seed >> 16)) * 0x85EBCA6Bu;
+            seed = (seed ^ (seed >> 13)) * 0xC2B2AE35u;
+            seed = seed ^ (seed >> 16);
+
+            //Xorshift never leaves zero, so it can't start there
+            State = seed ? seed : 1;
+        }
+
+        byte Next()
+        {
+            State ^= State << 13;
+            State ^= State >> 17;
+            State ^= State << 5;
+
+            return (byte)State;
+        }
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Base.h"
+
+namespace CHIP8
+{
+    //The registers of the CHIP8, laid out at fixed offsets so translated code can address them directly
+    struct Registers
+    {
+        static constexpr byte MaximumStackCount = 16;
+
+        word ProgramCounter = 0x0200;
+        word Index = 0x0000;
+
+        word Stack[MaximumStackCount] = { 0 };
+        sbyte StackPointer = -1;
+        byte DelayTimer = 0;
+        byte SoundTimer = 0;
+
+        byte Variable[0xF + 1] = { 0 };
+
+        //The user flags of SUPER-CHIP and XO-CHIP, which registers are saved to and restored from
+        byte Flags[0xF + 1] = { 0 };
+
+        //The audio of XO-CHIP: a pattern of 128 one-bit samples, played at 4000 * 2^((Pitch - 64) / 48) samples per second
+        byte Pattern[0xF + 1] = { 0 };
+        byte Pitch = 64;
+    };
+}
@@ -0,0 +1,172 @@
+#include "Emulator/Rewind.h"
+
+#include <algorithm>
+
+/*
+ * A delta is a sequence of runs, each one made of:
+ * - the number of bytes that didn't change
+ * - the number of bytes that did change
+ * - the XOR of every byte that did change
+ * Both counts are written 7 bits at a time, the high bit is set when more bits follow.
+ */
+
+namespace CHIP8
+{
+    namespace
+    {
+        void WriteCount(std::vector<byte>& delta, std::size_t count)
+        {
+            while (count >= 0x80)
+            {
+                delta.push_back((byte)(count | 0x80));
+                count >>= 7;
+            }
+
+            delta.push_back((byte)count);
+        }
+
+        std::size_t ReadCount(const byte*& data)
+        {
+            std::size_t count = 0;
+
+            for (int shift = 0;; shift += 7)
+            {
+                byte value = *data++;
+                count |= (std::size_t)(value & 0x7F) << shift;
+
+                if (!(value & 0x80))
+                {
+                    return count;
+                }
+            }
+        }
+    }
+
+    Rewind::Rewind(std::size_t capacity)
+        : m_Keyframe(Emulator::StateSize), m_Current(Emulator::StateSize), m_Deltas(std::max<std::size_t>(capacity, 1) - 1)
+    {
+    }
+
+    void Rewind::Push(const Emulator& emulator)
+    {
+        if (m_Count == 0)
+        {
+            emulator.SaveState(m_Keyframe.data());
+            m_Count = 1;
+
+            return;
+        }
+
+        emulator.SaveState(m_Current.data());
+
+        //A ring of a single frame only ever holds the keyframe
+        if (m_Deltas.empty())
+        {
+            m_Keyframe.swap(m_Current);
+            return;
+        }
+
+        //Without room for another delta, the oldest frame makes room
+        if (m_Count == GetCapacity())
+        {
+            m_First = (m_First + 1) % m_Deltas.size();
+            m_Count--;
+        }
+
+        //The old keyframe becomes a delta against the new one
+        std::vector<byte>& delta = m_Deltas[(m_First + m_Count - 1) % m_Deltas.size()];
+        delta.clear();
+
+        Encode(m_Keyframe.data(), m_Current.data(), Emulator::StateSize, delta);
+
+        m_Keyframe.swap(m_Current);
+        m_Count++;
+    }
+
+    bool Rewind::Pop(Emulator& emulator)
+    {
+        if (m_Count == 0)
+        {
+            return false;
+        }
+
+        emulator.LoadState(m_Keyframe.data(), m_Keyframe.size());
+        m_Count--;
+
+        //The frame before becomes the keyframe
+        if (m_Count > 0)
+        {
+            Decode(m_Deltas[(m_First + m_Count - 1) % m_Deltas.size()], m_Keyframe.data());
+        }
+
+        return true;
+    }
+
+    void Rewind::Clear()
+    {
+        m_First = 0;
+        m_Count = 0;
+    }
+
+    std::size_t Rewind::GetSize() const
+    {
+        std::size_t size = m_Count > 0 ? m_Keyframe.size() : 0;
+
+        for (std::size_t i = 0; i + 1 < m_Count; i++)
+        {
+            size += m_Deltas[(m_First + i) % m_Deltas.size()].size();
+        }
+
+        return size;
+    }
+
+    void Rewind::Encode(const byte* a, const byte* b, std::size_t size, std::vector<byte>& delta)
+    {
+        std::size_t i = 0;
+
+        while (i < size)
+        {
+            std::size_t start = i;
+
+            while (i < size && a[i] == b[i])
+            {
+                i++;
+            }
+
+            std::size_t unchanged = i - start;
+            start = i;
+
+            //A single unchanged byte inside a changed run is cheaper to keep than to start a new run for
+            while (i < size && (a[i] != b[i] || (i + 1 < size && a[i + 1] != b[i + 1])))
+            {
+                i++;
+            }
+
+            WriteCount(delta, unchanged);
+            WriteCount(delta, i - start);
+
+            for (std::size_t j = start; j < i; j++)
+            {
+                delta.push_back(a[j] ^ b[j]);
+            }
+        }
+    }
+
+    void Rewind::Decode(const std::vector<byte>& delta, byte* state)
+    {
+        const byte* data = delta.data();
+        const byte* end = data + delta.size();
+
+        while (data != end)
+        {
+            state += ReadCount(data);
+
+            std::size_t changed = ReadCount(data);
+
+            for (std::size_t j = 0; j < changed; j++)
+            {
+                *state++ ^= *data++;
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/Emulator.h"
+
+namespace CHIP8
+{
+    //Records the state of an emulator every frame, so it can be played backwards one frame at a time.
+    //
+    //The newest state is kept in full as the keyframe. Every older state is only kept as the XOR of it and
+    //the state after it, run-length encoded, so a frame costs about as many bytes as changed in it. Going
+    //back one frame decodes a single delta onto the keyframe, and dropping the oldest frame once the ring
+    //is full never invalidates the others.
+    class Rewind
+    {
+    public:
+        //Holds up to the given number of frames, 10 seconds at 60 Hz by default
+        Rewind(std::size_t capacity = 600);
+
+        //Records the current state as the newest frame, dropping the oldest one if the ring is full
+        void Push(const Emulator& emulator);
+
+        //Restores the newest frame and removes it, returns false if there is nothing left to rewind
+        bool Pop(Emulator& emulator);
+
+        void Clear();
+
+        std::size_t GetCount() const { return m_Count; }
+        std::size_t GetCapacity() const { return m_Deltas.size() + 1; }
+
+        //The number of bytes used by the recorded frames
+        std::size_t GetSize() const;
+
+    private:
+        //The newest state, and a scratch state used to build the next delta
+        std::vector<byte> m_Keyframe;
+        std::vector<byte> m_Current;
+
+        //The deltas of the older frames, oldest first starting at m_First. They keep their capacity when they're reused
+        std::vector<std::vector<byte>> m_Deltas;
+        std::size_t m_First = 0;
+
+        //The number of frames, including the keyframe
+        std::size_t m_Count = 0;
+
+        //Appends the run-length encoding of a XOR b
+        static void Encode(const byte* a, const byte* b, std::size_t size, std::vector<byte>& delta);
+
+        //XORs an encoded delta onto the state
+        static void Decode(const std::vector<byte>& delta, byte* state);
+    };
+}
@@ -0,0 +1,241 @@
+#include "Emulator/RomCache.h"
+
+#include <cstring>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace CHIP8
+{
+    std::shared_ptr<Rom> Rom::Map(const std::string& path)
+    {
+        std::shared_ptr<Rom> rom = MapContents(path);
+
+        if (rom)
+        {
+            rom->BuildImage();
+        }
+
+        return rom;
+    }
+
+    std::shared_ptr<Rom> Rom::MapContents(const std::string& path)
+    {
+        std::shared_ptr<Rom> rom(new Rom());
+
+    #if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        rom->m_Size = (std::size_t)size.QuadPart;
+
+        //Empty files can't be mapped, they're simply empty ROMs
+        if (rom->m_Size > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+            if (!data)
+            {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return nullptr;
+            }
+
+            rom->m_Copy.assign((const byte*)data, (const byte*)data + rom->m_Size);
+
+            UnmapViewOfFile(data);
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+    #else
+        int file = open(path.c_str(), O_RDONLY);
+
+        if (file < 0)
+        {
+            return nullptr;
+        }
+
+        struct stat status;
+
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            return nullptr;
+        }
+
+        rom->m_Size = (std::size_t)status.st_size;
+
+        //Empty files can't be mapped, they're simply empty ROMs
+        if (rom->m_Size > 0)
+        {
+            void* data = mmap(nullptr, rom->m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+
+            if (data == MAP_FAILED)
+            {
+                close(file);
+                return nullptr;
+            }
+
+            rom->m_Copy.assign((const byte*)data, (const byte*)data + rom->m_Size);
+
+            munmap(data, rom->m_Size);
+        }
+
+        close(file);
+    #endif
+
+        //Hashed from the copy, so the hash always describes the bytes the ROM holds
+        rom->m_Data = rom->m_Copy.data();
+        rom->Hash();
+
+        return rom;
+    }
+
+    std::shared_ptr<Rom> Rom::Copy(const byte* data, std::size_t size)
+    {
+        std::shared_ptr<Rom> rom(new Rom());
+
+        rom->m_Copy.assign(data, data + size);
+        rom->m_Data = rom->m_Copy.data();
+        rom->m_Size = size;
+
+        rom->Hash();
+        rom->BuildImage();
+
+        return rom;
+    }
+
+    void Rom::Hash()
+    {
+        //FNV-1a over every byte
+        m_Hash = 0xCBF29CE484222325ull;
+
+        for (std::size_t i = 0; i < m_Size; i++)
+        {
+            m_Hash ^= m_Data[i];
+            m_Hash *= 0x100000001B3ull;
+        }
+    }
+
+    void Rom::BuildImage()
+    {
+        //Only 0xFE00 bytes fit between 0x200 and the end of memory, programs for the 4 KB variants never see past 0xE00 of them
+        std::size_t size = m_Size < sizeof(m_Image.Memory) - MemoryImage::ProgramStart ? m_Size : sizeof(m_Image.Memory) - MemoryImage::ProgramStart;
+
+        if (size > 0)
+        {
+            memcpy(&m_Image.Memory[MemoryImage::ProgramStart], m_Data, size);
+        }
+    }
+
+    RomCache& RomCache::Global()
+    {
+        static RomCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const Rom> RomCache::Load(const std::string& path)
+    {
+        FileStamp stamp;
+
+        if (!GetStamp(path, stamp))
+        {
+            return nullptr;
+        }
+
+        //A file that wasn't touched since it was loaded still holds the same contents
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            auto file = m_Files.find(path);
+
+            if (file != m_Files.end() && file->second.Stamp == stamp)
+            {
+                return file->second.Contents;
+            }
+        }
+
+        //Read the file to find out what it contains, the copy is dropped again if the contents are already cached
+        std::shared_ptr<Rom> rom = Rom::MapContents(path);
+
+        if (!rom)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        std::vector<std::shared_ptr<const Rom>>& candidates = m_Roms[rom->GetHash()];
+
+        for (const std::shared_ptr<const Rom>& candidate : candidates)
+        {
+            if (candidate->GetSize() == rom->GetSize() && (rom->GetSize() == 0 || memcmp(candidate->GetData(), rom->GetData(), rom->GetSize()) == 0))
+            {
+                m_Files[path] = { stamp, candidate };
+                return candidate;
+            }
+        }
+
+        //Only new contents pay for an image
+        rom->BuildImage();
+
+        candidates.push_back(rom);
+        m_Files[path] = { stamp, rom };
+
+        return rom;
+    }
+
+    void RomCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Roms.clear();
+        m_Files.clear();
+    }
+
+    bool RomCache::GetStamp(const std::string& path, FileStamp& stamp)
+    {
+    #if defined(_WIN32)
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+        {
+            return false;
+        }
+
+        stamp.Size = ((std::uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+        stamp.ModifiedTime = ((std::uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    #else
+        struct stat status;
+
+        if (stat(path.c_str(), &status) != 0)
+        {
+            return false;
+        }
+
+        stamp.Size = (std::uint64_t)status.st_size;
+
+        //In nanoseconds, a file rewritten within the same second still gets a new stamp
+        #if defined(__APPLE__)
+            stamp.ModifiedTime = (std::uint64_t)status.st_mtimespec.tv_sec * 1000000000 + status.st_mtimespec.tv_nsec;
+        #else
+            stamp.ModifiedTime = (std::uint64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+        #endif
+    #endif
+
+        return true;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/MemoryImage.h"
+
+namespace CHIP8
+{
+    //The contents of a ROM, shared by every emulator running it, along with the memory it starts in.
+    //Files are read through a mapping that is dropped as soon as the contents are copied out of it, so a file
+    //truncated or rewritten later never changes, or faults, a ROM that is already loaded
+    class Rom
+    {
+        friend class RomCache;
+
+    public:
+        Rom(const Rom&) = delete;
+        Rom& operator=(const Rom&) = delete;
+
+        //Reads the whole file through a mapping, returns nullptr if it can't be opened or mapped
+        static std::shared_ptr<Rom> Map(const std::string& path);
+
+        //Copies a program that doesn't come from a file
+        static std::shared_ptr<Rom> Copy(const byte* data, std::size_t size);
+
+        const byte* GetData() const { return m_Data; }
+        std::size_t GetSize() const { return m_Size; }
+
+        //FNV-1a of the contents, identical files have identical hashes wherever they are
+        std::uint64_t GetHash() const { return m_Hash; }
+
+        //The font with the ROM at 0x200, what memory looks like after a reset
+        const MemoryImage& GetImage() const { return m_Image; }
+
+    private:
+        Rom() = default;
+
+        const byte* m_Data = nullptr;
+        std::size_t m_Size = 0;
+        std::uint64_t m_Hash = 0;
+
+        MemoryImage m_Image;
+
+        //Every ROM owns its data, m_Data points into it
+        std::vector<byte> m_Copy;
+
+        //Copies the file out of a mapping and hashes it, without building the image
+        static std::shared_ptr<Rom> MapContents(const std::string& path);
+
+        //Hashes the contents, once the data is in place
+        void Hash();
+
+        //Copies the contents into the image, only done for ROMs that aren't cached yet
+        void BuildImage();
+    };
+
+    //Keeps one copy of each distinct ROM for the whole process, so loading the same file again, or a copy
+    //of it under another name, hands out the image that is already mapped
+    class RomCache
+    {
+    public:
+        static RomCache& Global();
+
+        //Returns the cached ROM with the same contents as the file, reading it the first time.
+        //A path loaded before is only mapped again if its size or modification time changed
+        std::shared_ptr<const Rom> Load(const std::string& path);
+
+        //Forgets every ROM, each stays alive for as long as an emulator still holds it
+        void Clear();
+
+    private:
+        std::mutex m_Mutex;
+
+        //What a file looked like when it was loaded
+        struct FileStamp
+        {
+            std::uint64_t Size = 0;
+            std::uint64_t ModifiedTime = 0;
+
+            bool operator==(const FileStamp& other) const { return Size == other.Size && ModifiedTime == other.ModifiedTime; }
+        };
+
+        struct LoadedFile
+        {
+            FileStamp Stamp;
+            std::shared_ptr<const Rom> Contents;
+        };
+
+        //Indexed by the hash of the contents, ROMs sharing a hash are told apart by their bytes
+        std::unordered_map<std::uint64_t, std::vector<std::shared_ptr<const Rom>>> m_Roms;
+
+        //Indexed by path, so loading a file again takes a single stat instead of reading and hashing it
+        std::unordered_map<std::string, LoadedFile> m_Files;
+
+        //Returns false if the file doesn't exist
+        static bool GetStamp(const std::string& path, FileStamp& stamp);
+    };
+}
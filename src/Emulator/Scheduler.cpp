@@ -0,0 +1,193 @@
+#include "Emulator/Scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ratio>
+#include <thread>
+
+namespace CHIP8
+{
+    namespace
+    {
+        using Frame = std::chrono::duration<std::int64_t, std::ratio<1, Scheduler::TimerFrequency>>;
+
+        //How far the host can fall behind before the lost time is skipped
+        constexpr Frame MaximumLag(6);
+    }
+
+    Scheduler::Scheduler(Emulator& emulator, std::uint32_t clockSpeed)
+        : m_Emulator(emulator), m_ClockSpeed(std::max<std::uint32_t>(clockSpeed, 1))
+    {
+        Reschedule();
+    }
+
+    void Scheduler::SetClockSpeed(std::uint32_t clockSpeed)
+    {
+        m_ClockSpeed.store(std::max<std::uint32_t>(clockSpeed, 1), std::memory_order_relaxed);
+    }
+
+    void Scheduler::SetStackSampler(StackSampler* sampler)
+    {
+        m_StackSampler = sampler;
+        m_NextSample = sampler ? m_Cycles + sampler->GetInterval() : UINT64_MAX;
+    }
+
+    void Scheduler::SetKeypadQueue(KeypadQueue* queue, std::vector<KeyEvent>* log)
+    {
+        m_KeypadQueue = queue;
+        m_KeyLog = log;
+    }
+
+    void Scheduler::ApplyKeys()
+    {
+        KeyEvent event;
+        event.Cycle = m_Cycles;
+
+        while (m_KeypadQueue->Pop(event.Key, event.Pressed))
+        {
+            m_Emulator.SetKey(event.Key, event.Pressed);
+
+            if (m_KeyLog)
+            {
+                m_KeyLog->push_back(event);
+            }
+        }
+    }
+
+    void Scheduler::Reschedule()
+    {
+        std::uint32_t clockSpeed = m_ClockSpeed.load(std::memory_order_relaxed);
+
+        if (clockSpeed == m_ScheduledClockSpeed)
+        {
+            return;
+        }
+
+        m_ScheduledClockSpeed = clockSpeed;
+        m_BaseTick = m_Ticks;
+        m_BaseCycle = m_Cycles;
+
+        //Tick N of the schedule happens once N / 60 seconds worth of instructions have run, rounded up
+        m_NextTick = m_BaseCycle + (clockSpeed + TimerFrequency - 1) / TimerFrequency;
+    }
+
+    void Scheduler::RunCycles(std::uint64_t cycles)
+    {
+        Reschedule();
+
+        while (cycles > 0)
+        {
+            std::uint64_t count = std::min({ cycles, m_NextTick - m_Cycles, m_NextSample - m_Cycles });
+
+            m_Emulator.Execute(count);
+            m_Cycles += count;
+            cycles -= count;
+
+            if (m_Cycles == m_NextSample)
+            {
+                m_StackSampler->Sample(m_Emulator);
+                m_NextSample += m_StackSampler->GetInterval();
+            }
+
+            //Below 60 Hz several ticks can be due at the same cycle
+            while (m_Cycles == m_NextTick)
+            {
+                //The frame that just ended beeped if the sound timer was still running at its end
+                if (m_AudioGenerator)
+                {
+                    const Registers& registers = m_Emulator.GetRegisters();
+                    bool sounding = registers.SoundTimer > 0;
+
+                    //Only XO-CHIP programs can load an audio pattern
+                    if (m_Emulator.GetQuirks() == QuirkProfile::XoChip)
+                    {
+                        m_AudioGenerator->GenerateFrame(sounding, registers.Pattern, registers.Pitch);
+                    }
+                    else
+                    {
+                        m_AudioGenerator->GenerateFrame(sounding);
+                    }
+                }
+
+                m_Emulator.TickTimers();
+                m_Ticks++;
+
+                std::uint64_t ticks = m_Ticks + 1 - m_BaseTick;
+                m_NextTick = m_BaseCycle + (ticks * m_ScheduledClockSpeed + TimerFrequency - 1) / TimerFrequency;
+
+                if (m_FrameBuffer)
+                {
+                    m_FrameBuffer->Publish(m_Emulator, m_Ticks);
+                }
+
+                //Keys only change on a tick, the host can't tell instructions apart anyway
+                if (m_KeypadQueue)
+                {
+                    ApplyKeys();
+                }
+            }
+        }
+    }
+
+    void Scheduler::RunFrame()
+    {
+        Reschedule();
+        RunCycles(m_NextTick - m_Cycles);
+    }
+
+    void Scheduler::RunScript(const std::vector<KeyEvent>& events, std::uint64_t cycles)
+    {
+        std::size_t next = 0;
+
+        while (m_Cycles < cycles)
+        {
+            //Apply every key event that is due
+            for (; next < events.size() && events[next].Cycle <= m_Cycles; next++)
+            {
+                m_Emulator.SetKey(events[next].Key, events[next].Pressed);
+            }
+
+            //Run up to the next key event or the end, whichever comes first
+            std::uint64_t stop = cycles;
+
+            if (next < events.size())
+            {
+                stop = std::min(stop, events[next].Cycle);
+            }
+
+            RunCycles(stop - m_Cycles);
+        }
+    }
+
+    void Scheduler::Run()
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t startTick = m_Ticks;
+        bool paced = false;
+
+        while (!m_Stopped.load(std::memory_order_relaxed))
+        {
+            RunFrame();
+
+            //Turbo never looks at the wall clock, pacing starts over from wherever it is turned off
+            if (IsTurbo())
+            {
+                paced = false;
+                continue;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(Frame(m_Ticks - startTick));
+
+            if (!paced || now - due > MaximumLag)
+            {
+                start = now;
+                startTick = m_Ticks;
+                paced = true;
+                continue;
+            }
+
+            std::this_thread::sleep_until(due);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Base.h"
+#include "Audio/AudioGenerator.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/FrameBuffer.h"
+#include "Emulator/KeypadQueue.h"
+#include "Emulator/StackSampler.h"
+
+namespace CHIP8
+{
+    //Drives an emulator through emulated time. Instructions run at the clock speed, and the delay and sound
+    //timers tick at exactly 60 Hz of emulated time. Emulated time only depends on the number of instructions
+    //executed, so a run ends up the same whether it's paced to the wall clock or runs in turbo.
+    class Scheduler
+    {
+    public:
+        static constexpr std::uint32_t TimerFrequency = 60;
+
+        //12 instructions per timer tick
+        static constexpr std::uint32_t DefaultClockSpeed = 720;
+
+        Scheduler(Emulator& emulator, std::uint32_t clockSpeed = DefaultClockSpeed);
+
+        //Instructions per second of emulated time, at least 1. Takes effect at the next instruction run,
+        //the timer ticks that already happened are kept
+        void SetClockSpeed(std::uint32_t clockSpeed);
+        std::uint32_t GetClockSpeed() const { return m_ClockSpeed.load(std::memory_order_relaxed); }
+
+        //Runs as fast as the host allows instead of keeping pace with the wall clock
+        void SetTurbo(bool turbo) { m_Turbo.store(turbo, std::memory_order_relaxed); }
+        bool IsTurbo() const { return m_Turbo.load(std::memory_order_relaxed); }
+
+        //Executes the given number of instructions, ticking the timers whenever 1/60 of a second of emulated time
+        //has passed. Never waits for the wall clock
+        void RunCycles(std::uint64_t cycles);
+
+        //Executes the instructions up to and including the next timer tick
+        void RunFrame();
+
+        //Executes instructions until the given number have run since the scheduler was created, pressing and releasing
+        //the keys of the events at their cycles. Events at a cycle that already passed are applied straight away
+        void RunScript(const std::vector<KeyEvent>& events, std::uint64_t cycles);
+
+        //Runs frame after frame until Stop() is called, paced to the wall clock unless in turbo.
+        //A host that falls behind skips ahead instead of trying to catch up
+        void Run();
+
+        //Samples the call stack every interval of the sampler, in instructions executed from now on.
+        //Null stops sampling, the sampler has to outlive every run it's used for
+        void SetStackSampler(StackSampler* sampler);
+
+        //Applies the key events of a queue at every timer tick, so when they take effect only depends on emulated time.
+        //Every event applied is added to the log with the cycle it took effect at, if there is a log. The log replays
+        //the run exactly as an input script. Null stops reading the queue, both have to outlive every run they're used for
+        void SetKeypadQueue(KeypadQueue* queue, std::vector<KeyEvent>* log = nullptr);
+
+        //Publishes the display at every timer tick, for a renderer on another thread.
+        //Null stops publishing, the frame buffer has to outlive every run it's used for
+        void SetFrameBuffer(FrameBuffer* frames) { m_FrameBuffer = frames; }
+
+        //Generates a frame of audio at every timer tick, from whether the sound timer ran during the frame.
+        //Null stops generating, the generator has to outlive every run it's used for
+        void SetAudioGenerator(AudioGenerator* audio) { m_AudioGenerator = audio; }
+
+        //Makes Run() return after the current frame, can be called from any thread. The request is kept,
+        //so a Stop() that comes before Run() even starts makes it return straight away
+        void Stop() { m_Stopped.store(true, std::memory_order_relaxed); }
+
+        //The number of instructions executed and timer ticks since the scheduler was created
+        std::uint64_t GetCycles() const { return m_Cycles; }
+        std::uint64_t GetTicks() const { return m_Ticks; }
+
+    private:
+        Emulator& m_Emulator;
+
+        std::atomic<std::uint32_t> m_ClockSpeed;
+        std::atomic<bool> m_Turbo{ false };
+        std::atomic<bool> m_Stopped{ false };
+
+        std::uint64_t m_Cycles = 0;
+        std::uint64_t m_Ticks = 0;
+
+        //The clock speed the tick schedule was computed with, and the tick and cycle count it was computed from
+        std::uint32_t m_ScheduledClockSpeed = 0;
+        std::uint64_t m_BaseTick = 0;
+        std::uint64_t m_BaseCycle = 0;
+
+        //The cycle count the next timer tick happens at
+        std::uint64_t m_NextTick = 0;
+
+        StackSampler* m_StackSampler = nullptr;
+
+        //The cycle count the next stack sample is taken at, never without a sampler
+        std::uint64_t m_NextSample = UINT64_MAX;
+
+        FrameBuffer* m_FrameBuffer = nullptr;
+        AudioGenerator* m_AudioGenerator = nullptr;
+
+        KeypadQueue* m_KeypadQueue = nullptr;
+        std::vector<KeyEvent>* m_KeyLog = nullptr;
+
+        //Applies every key event waiting in the queue
+        void ApplyKeys();
+
+        //Starts a new tick schedule at the current cycle if the clock speed changed
+        void Reschedule();
+    };
+}
@@ -0,0 +1,86 @@
+#include "Emulator/StackSampler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace CHIP8
+{
+    StackSampler::StackSampler(std::uint64_t interval, const std::string& root)
+        : m_Interval(std::max<std::uint64_t>(interval, 1))
+    {
+        SetRoot(root);
+    }
+
+    void StackSampler::SetRoot(const std::string& root)
+    {
+        m_Root = root;
+        std::replace(m_Root.begin(), m_Root.end(), ';', '_');
+    }
+
+    void StackSampler::Sample(const Emulator& emulator)
+    {
+        const Registers& registers = emulator.GetRegisters();
+
+        m_Stack = m_Root;
+
+        //Every entry of the stack is a return address, right after the CALL addr that entered the subroutine
+        for (sbyte frame = 0; frame <= registers.StackPointer; frame++)
+        {
+            word call = (registers.Stack[frame] - 2) & 0xFFF;
+            byte hi = emulator.ReadMemory(call);
+            byte lo = emulator.ReadMemory((call + 1) & 0xFFF);
+
+            //The call might have been overwritten since, then there is no telling where it went
+            char name[8];
+
+            if ((hi >> 4) == 0x2)
+            {
+                snprintf(name, sizeof(name), "0x%03X", ((hi & 0xF) << 8) | lo);
+            }
+            else
+            {
+                snprintf(name, sizeof(name), "unknown");
+            }
+
+            m_Stack += ';';
+            m_Stack += name;
+        }
+
+        auto sample = m_Samples.find(m_Stack);
+
+        if (sample != m_Samples.end())
+        {
+            sample->second++;
+        }
+        else
+        {
+            m_Samples.emplace(m_Stack, 1);
+        }
+
+        m_SampleCount++;
+    }
+
+    void StackSampler::Merge(const StackSampler& other)
+    {
+        for (const auto& sample : other.m_Samples)
+        {
+            m_Samples[sample.first] += sample.second;
+        }
+
+        m_SampleCount += other.m_SampleCount;
+    }
+
+    void StackSampler::Clear()
+    {
+        m_Samples.clear();
+        m_SampleCount = 0;
+    }
+
+    void StackSampler::WriteCollapsed(std::ostream& output) const
+    {
+        for (const auto& sample : m_Samples)
+        {
+            output << sample.first << ' ' << sample.second << '\n';
+        }
+    }
+}
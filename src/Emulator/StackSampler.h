@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "Base.h"
+#include "Emulator/Emulator.h"
+
+namespace CHIP8
+{
+    //Samples the subroutine call stack of the guest every so many instructions. The samples are written in the
+    //collapsed format flame graph tools read: one line per distinct stack, its frames separated by semicolons,
+    //followed by the number of samples. Subroutines are named after the address they were called at, like 0x2A4
+    class StackSampler
+    {
+    public:
+        static constexpr std::uint64_t DefaultInterval = 100;
+
+        //Samples every interval instructions, the outermost frame of every stack gets the root name
+        StackSampler(std::uint64_t interval = DefaultInterval, const std::string& root = "main");
+
+        std::uint64_t GetInterval() const { return m_Interval; }
+
+        //Names the outermost frame of the stacks sampled from now on, like the ROM being run.
+        //Semicolons separate the frames, so they are replaced
+        void SetRoot(const std::string& root);
+
+        //Records the call stack the emulator is in right now
+        void Sample(const Emulator& emulator);
+
+        //Adds the samples of another sampler to this one
+        void Merge(const StackSampler& other);
+
+        void Clear();
+
+        std::uint64_t GetSampleCount() const { return m_SampleCount; }
+
+        //Writes one line per distinct stack, sorted by the stack
+        void WriteCollapsed(std::ostream& output) const;
+
+    private:
+        std::uint64_t m_Interval;
+        std::string m_Root;
+
+        //The stack being sampled, kept around so sampling a known stack doesn't allocate
+        std::string m_Stack;
+
+        std::map<std::string, std::uint64_t> m_Samples;
+        std::uint64_t m_SampleCount = 0;
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Base.h"
+#include "Emulator/BlockCache.h"
+#include "Emulator/Quirks.h"
+
+namespace CHIP8
+{
+    //A block compiled ahead of time from a ROM by the recompiler
+    struct StaticBlock
+    {
+        //The address of the first instruction
+        word Start = 0x0000;
+
+        //The number of instructions in this block
+        byte Length = 0;
+
+        //The bytes this block was compiled from, used to detect self-modified code
+        const byte* Code = nullptr;
+
+        //The compiled block, called like a block compiled by the JIT
+        NativeBlock Function = nullptr;
+    };
+
+    //Every block compiled from a ROM, sorted by their start address
+    struct StaticProgram
+    {
+        const StaticBlock* Blocks = nullptr;
+        std::size_t Count = 0;
+
+        //The blocks only run on emulators using the profile they were compiled for
+        QuirkProfile Quirks = QuirkProfile::Modern;
+    };
+}
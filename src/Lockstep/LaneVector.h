@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Base.h"
+
+//Pick the widest vector instructions the compiler is allowed to use
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CHIP8_LANES_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CHIP8_LANES_SSE2
+#endif
+
+namespace CHIP8
+{
+    //A group of 8-bit lanes, one per instance, processed with a single instruction.
+    //Masks are lanes set to either 0x00 or 0xFF.
+    struct LaneVector
+    {
+    #if defined(CHIP8_LANES_AVX2)
+        static constexpr std::size_t Width = 32;
+
+        __m256i Value;
+
+        static LaneVector Load(const byte* lanes) { return { _mm256_loadu_si256((const __m256i*)lanes) }; }
+        void Store(byte* lanes) const { _mm256_storeu_si256((__m256i*)lanes, Value); }
+        static LaneVector Broadcast(byte value) { return { _mm256_set1_epi8((char)value) }; }
+
+        friend LaneVector operator+(LaneVector a, LaneVector b) { return { _mm256_add_epi8(a.Value, b.Value) }; }
+        friend LaneVector operator-(LaneVector a, LaneVector b) { return { _mm256_sub_epi8(a.Value, b.Value) }; }
+        friend LaneVector operator|(LaneVector a, LaneVector b) { return { _mm256_or_si256(a.Value, b.Value) }; }
+        friend LaneVector operator&(LaneVector a, LaneVector b) { return { _mm256_and_si256(a.Value, b.Value) }; }
+        friend LaneVector operator^(LaneVector a, LaneVector b) { return { _mm256_xor_si256(a.Value, b.Value) }; }
+
+        static LaneVector Equal(LaneVector a, LaneVector b) { return { _mm256_cmpeq_epi8(a.Value, b.Value) }; }
+        static LaneVector Maximum(LaneVector a, LaneVector b) { return { _mm256_max_epu8(a.Value, b.Value) }; }
+        static LaneVector SaturatingSubtract(LaneVector a, LaneVector b) { return { _mm256_subs_epu8(a.Value, b.Value) }; }
+
+        //Logical shifts of every lane, there are no 8-bit shifts so the bits crossing lanes are masked off
+        static LaneVector ShiftRight1(LaneVector a) { return LaneVector{ _mm256_srli_epi16(a.Value, 1) } & Broadcast(0x7F); }
+        static LaneVector ShiftRight7(LaneVector a) { return LaneVector{ _mm256_srli_epi16(a.Value, 7) } & Broadcast(0x01); }
+
+        //Takes a where the mask is set, and b everywhere else
+        static LaneVector Select(LaneVector mask, LaneVector a, LaneVector b) { return { _mm256_blendv_epi8(b.Value, a.Value, mask.Value) }; }
+
+        //Whether the mask is set in any lane, or in every lane
+        static bool Any(LaneVector mask) { return _mm256_movemask_epi8(mask.Value) != 0; }
+        static bool All(LaneVector mask) { return _mm256_movemask_epi8(mask.Value) == -1; }
+
+        //Packs the 16-bit masks of as many lanes into 8-bit masks, packing works within each half so the quarters are put back in order
+        static LaneVector Narrow(const word* masks) { return { _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_loadu_si256((const __m256i*)masks), _mm256_loadu_si256((const __m256i*)(masks + 16))), 0xD8) }; }
+    #elif defined(CHIP8_LANES_SSE2)
+        static constexpr std::size_t Width = 16;
+
+        __m128i Value;
+
+        static LaneVector Load(const byte* lanes) { return { _mm_loadu_si128((const __m128i*)lanes) }; }
+        void Store(byte* lanes) const { _mm_storeu_si128((__m128i*)lanes, Value); }
+        static LaneVector Broadcast(byte value) { return { _mm_set1_epi8((char)value) }; }
+
+        friend LaneVector operator+(LaneVector a, LaneVector b) { return { _mm_add_epi8(a.Value, b.Value) }; }
+        friend LaneVector operator-(LaneVector a, LaneVector b) { return { _mm_sub_epi8(a.Value, b.Value) }; }
+        friend LaneVector operator|(LaneVector a, LaneVector b) { return { _mm_or_si128(a.Value, b.Value) }; }
+        friend LaneVector operator&(LaneVector a, LaneVector b) { return { _mm_and_si128(a.Value, b.Value) }; }
+        friend LaneVector operator^(LaneVector a, LaneVector b) { return { _mm_xor_si128(a.Value, b.Value) }; }
+
+        static LaneVector Equal(LaneVector a, LaneVector b) { return { _mm_cmpeq_epi8(a.Value, b.Value) }; }
+        static LaneVector Maximum(LaneVector a, LaneVector b) { return { _mm_max_epu8(a.Value, b.Value) }; }
+        static LaneVector SaturatingSubtract(LaneVector a, LaneVector b) { return { _mm_subs_epu8(a.Value, b.Value) }; }
+
+        //Logical shifts of every lane, there are no 8-bit shifts so the bits crossing lanes are masked off
+        static LaneVector ShiftRight1(LaneVector a) { return LaneVector{ _mm_srli_epi16(a.Value, 1) } & Broadcast(0x7F); }
+        static LaneVector ShiftRight7(LaneVector a) { return LaneVector{ _mm_srli_epi16(a.Value, 7) } & Broadcast(0x01); }
+
+        //Takes a where the mask is set, and b everywhere else
+        static LaneVector Select(LaneVector mask, LaneVector a, LaneVector b) { return { _mm_or_si128(_mm_and_si128(mask.Value, a.Value), _mm_andnot_si128(mask.Value, b.Value)) }; }
+
+        //Whether the mask is set in any lane, or in every lane
+        static bool Any(LaneVector mask) { return _mm_movemask_epi8(mask.Value) != 0; }
+        static bool All(LaneVector mask) { return _mm_movemask_epi8(mask.Value) == 0xFFFF; }
+
+        //Packs the 16-bit masks of as many lanes into 8-bit masks
+        static LaneVector Narrow(const word* masks) { return { _mm_packs_epi16(_mm_loadu_si128((const __m128i*)masks), _mm_loadu_si128((const __m128i*)(masks + 8))) }; }
+    #else
+        static constexpr std::size_t Width = 1;
+
+        byte Value;
+
+        static LaneVector Load(const byte* lanes) { return { *lanes }; }
+        void Store(byte* lanes) const { *lanes = Value; }
+        static LaneVector Broadcast(byte value) { return { value }; }
+
+        friend LaneVector operator+(LaneVector a, LaneVector b) { return { (byte)(a.Value + b.Value) }; }
+        friend LaneVector operator-(LaneVector a, LaneVector b) { return { (byte)(a.Value - b.Value) }; }
+        friend LaneVector operator|(LaneVector a, LaneVector b) { return { (byte)(a.Value | b.Value) }; }
+        friend LaneVector operator&(LaneVector a, LaneVector b) { return { (byte)(a.Value & b.Value) }; }
+        friend LaneVector operator^(LaneVector a, LaneVector b) { return { (byte)(a.Value ^ b.Value) }; }
+
+        static LaneVector Equal(LaneVector a, LaneVector b) { return { (byte)(a.Value == b.Value ? 0xFF : 0x00) }; }
+        static LaneVector Maximum(LaneVector a, LaneVector b) { return { a.Value > b.Value ? a.Value : b.Value }; }
+        static LaneVector SaturatingSubtract(LaneVector a, LaneVector b) { return { (byte)(a.Value > b.Value ? a.Value - b.Value : 0) }; }
+
+        static LaneVector ShiftRight1(LaneVector a) { return { (byte)(a.Value >> 1) }; }
+        static LaneVector ShiftRight7(LaneVector a) { return { (byte)(a.Value >> 7) }; }
+
+        static LaneVector Select(LaneVector mask, LaneVector a, LaneVector b) { return { (byte)((mask.Value & a.Value) | (~mask.Value & b.Value)) }; }
+
+        static bool Any(LaneVector mask) { return mask.Value != 0; }
+        static bool All(LaneVector mask) { return mask.Value == 0xFF; }
+
+        static LaneVector Narrow(const word* masks) { return { (byte)*masks }; }
+    #endif
+
+        //Unsigned a > b in every lane
+        static LaneVector GreaterThan(LaneVector a, LaneVector b) { return Equal(Maximum(a, b), b) ^ Broadcast(0xFF); }
+    };
+
+    //A group of 16-bit lanes for the program counters and index registers, half as many as LaneVector holds.
+    //Masks are lanes set to either 0x0000 or 0xFFFF. Every value kept in these lanes is below 0x8000,
+    //so the signed comparisons SSE2 has work for them as well.
+    struct WordVector
+    {
+    #if defined(CHIP8_LANES_AVX2)
+        static constexpr std::size_t Width = 16;
+
+        __m256i Value;
+
+        static WordVector Load(const word* lanes) { return { _mm256_loadu_si256((const __m256i*)lanes) }; }
+        void Store(word* lanes) const { _mm256_storeu_si256((__m256i*)lanes, Value); }
+        static WordVector Broadcast(word value) { return { _mm256_set1_epi16((short)value) }; }
+
+        //Zero extends the 8-bit lanes of as many instances, or sign extends their masks
+        static WordVector Widen(const byte* lanes) { return { _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)lanes)) }; }
+        static WordVector WidenMask(const byte* masks) { return { _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)masks)) }; }
+
+        friend WordVector operator+(WordVector a, WordVector b) { return { _mm256_add_epi16(a.Value, b.Value) }; }
+        friend WordVector operator-(WordVector a, WordVector b) { return { _mm256_sub_epi16(a.Value, b.Value) }; }
+        friend WordVector operator|(WordVector a, WordVector b) { return { _mm256_or_si256(a.Value, b.Value) }; }
+        friend WordVector operator&(WordVector a, WordVector b) { return { _mm256_and_si256(a.Value, b.Value) }; }
+        friend WordVector operator^(WordVector a, WordVector b) { return { _mm256_xor_si256(a.Value, b.Value) }; }
+
+        static WordVector Equal(WordVector a, WordVector b) { return { _mm256_cmpeq_epi16(a.Value, b.Value) }; }
+        static WordVector Minimum(WordVector a, WordVector b) { return { _mm256_min_epi16(a.Value, b.Value) }; }
+
+        static WordVector Select(WordVector mask, WordVector a, WordVector b) { return { _mm256_blendv_epi8(b.Value, a.Value, mask.Value) }; }
+
+        static bool Any(WordVector mask) { return _mm256_movemask_epi8(mask.Value) != 0; }
+    #elif defined(CHIP8_LANES_SSE2)
+        static constexpr std::size_t Width = 8;
+
+        __m128i Value;
+
+        static WordVector Load(const word* lanes) { return { _mm_loadu_si128((const __m128i*)lanes) }; }
+        void Store(word* lanes) const { _mm_storeu_si128((__m128i*)lanes, Value); }
+        static WordVector Broadcast(word value) { return { _mm_set1_epi16((short)value) }; }
+
+        //Zero extends the 8-bit lanes of as many instances, or sign extends their masks
+        static WordVector Widen(const byte* lanes) { return { _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)lanes), _mm_setzero_si128()) }; }
+        static WordVector WidenMask(const byte* masks) { __m128i value = _mm_loadl_epi64((const __m128i*)masks); return { _mm_unpacklo_epi8(value, value) }; }
+
+        friend WordVector operator+(WordVector a, WordVector b) { return { _mm_add_epi16(a.Value, b.Value) }; }
+        friend WordVector operator-(WordVector a, WordVector b) { return { _mm_sub_epi16(a.Value, b.Value) }; }
+        friend WordVector operator|(WordVector a, WordVector b) { return { _mm_or_si128(a.Value, b.Value) }; }
+        friend WordVector operator&(WordVector a, WordVector b) { return { _mm_and_si128(a.Value, b.Value) }; }
+        friend WordVector operator^(WordVector a, WordVector b) { return { _mm_xor_si128(a.Value, b.Value) }; }
+
+        static WordVector Equal(WordVector a, WordVector b) { return { _mm_cmpeq_epi16(a.Value, b.Value) }; }
+        static WordVector Minimum(WordVector a, WordVector b) { return { _mm_min_epi16(a.Value, b.Value) }; }
+
+        static WordVector Select(WordVector mask, WordVector a, WordVector b) { return { _mm_or_si128(_mm_and_si128(mask.Value, a.Value), _mm_andnot_si128(mask.Value, b.Value)) }; }
+
+        static bool Any(WordVector mask) { return _mm_movemask_epi8(mask.Value) != 0; }
+    #else
+        static constexpr std::size_t Width = 1;
+
+        word Value;
+
+        static WordVector Load(const word* lanes) { return { *lanes }; }
+        void Store(word* lanes) const { *lanes = Value; }
+        static WordVector Broadcast(word value) { return { value }; }
+
+        static WordVector Widen(const byte* lanes) { return { *lanes }; }
+        static WordVector WidenMask(const byte* masks) { return { (word)(sbyte)*masks }; }
+
+        friend WordVector operator+(WordVector a, WordVector b) { return { (word)(a.Value + b.Value) }; }
+        friend WordVector operator-(WordVector a, WordVector b) { return { (word)(a.Value - b.Value) }; }
+        friend WordVector operator|(WordVector a, WordVector b) { return { (word)(a.Value | b.Value) }; }
+        friend WordVector operator&(WordVector a, WordVector b) { return { (word)(a.Value & b.Value) }; }
+        friend WordVector operator^(WordVector a, WordVector b) { return { (word)(a.Value ^ b.Value) }; }
+
+        static WordVector Equal(WordVector a, WordVector b) { return { (word)(a.Value == b.Value ? 0xFFFF : 0x0000) }; }
+        static WordVector Minimum(WordVector a, WordVector b) { return { a.Value < b.Value ? a.Value : b.Value }; }
+
+        static WordVector Select(WordVector mask, WordVector a, WordVector b) { return { (word)((mask.Value & a.Value) | (~mask.Value & b.Value)) }; }
+
+        static bool Any(WordVector mask) { return mask.Value != 0; }
+    #endif
+
+        //The smallest of the lanes
+        word Smallest() const
+        {
+            word lanes[Width];
+            Store(lanes);
+
+            word smallest = lanes[0];
+            for (std::size_t lane = 1; lane < Width; lane++)
+            {
+                smallest = lanes[lane] < smallest ? lanes[lane] : smallest;
+            }
+
+            return smallest;
+        }
+    };
+}
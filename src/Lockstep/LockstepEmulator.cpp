@@ -0,0 +1,911 @@
+#include "Lockstep/LockstepEmulator.h"
+#include "Lockstep/LaneVector.h"
+#include "Emulator/Font.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CHIP8
+{
+    LockstepEmulator::LockstepEmulator(std::size_t count, std::uint32_t seed)
+        : m_Count(count)
+    {
+        //Pad the lanes to whole vectors, the padding lanes are never active
+        m_LaneCount = std::max<std::size_t>((count + LaneVector::Width - 1) / LaneVector::Width * LaneVector::Width, LaneVector::Width);
+
+        m_ProgramCounter.resize(m_LaneCount);
+        m_Index.resize(m_LaneCount);
+        for (std::vector<word>& stack : m_Stack)
+        {
+            stack.resize(m_LaneCount);
+        }
+        m_StackPointer.resize(m_LaneCount);
+        m_DelayTimer.resize(m_LaneCount);
+        m_SoundTimer.resize(m_LaneCount);
+        for (std::vector<byte>& variable : m_Variable)
+        {
+            variable.resize(m_LaneCount);
+        }
+
+        m_Keys.resize(m_LaneCount);
+        m_Random.resize(m_LaneCount);
+
+        m_Memory.resize(count * MemorySize);
+        m_Display.resize(count * DisplayHeight);
+
+        m_DecodedInstructions.resize(MemorySize);
+        m_Written.resize(MemorySize);
+
+        m_Remaining.resize(m_LaneCount);
+        m_Condition.resize(m_LaneCount);
+        m_Active.resize(m_LaneCount);
+        m_ActiveWords.resize(m_LaneCount);
+
+        //Give every instance its own random sequence, mixing the lane into the seed
+        for (std::size_t lane = 0; lane < m_LaneCount; lane++)
+        {
+            m_Random[lane].Seed(seed + (std::uint32_t)lane * 0x9E3779B9u);
+        }
+
+        LoadProgram(nullptr, 0);
+    }
+
+    LockstepEmulator::~LockstepEmulator()
+    {
+
+    }
+
+    void LockstepEmulator::LoadProgram(const byte* program, std::size_t size)
+    {
+        //Only 0xE00 bytes fit between 0x200 and the end of memory
+        size = std::min<std::size_t>(size, MemorySize - 0x200);
+
+        //Every instance starts with the same memory
+        std::vector<byte> image(MemorySize);
+        memcpy(&image[0x000], &Font[0x00], sizeof(Font));
+        memcpy(&image[BigFontAddress], &BigFont[0x00], sizeof(BigFont));
+
+        if (size > 0)
+        {
+            memcpy(&image[0x200], program, size);
+        }
+
+        for (std::size_t instance = 0; instance < m_Count; instance++)
+        {
+            memcpy(&m_Memory[instance * MemorySize], image.data(), MemorySize);
+        }
+
+        //Until an instance writes to memory, the instructions it fetches are the same as everyone else's
+        for (std::size_t address = 0; address < MemorySize; address++)
+        {
+            m_DecodedInstructions[address] = Decode(((word)image[address] << 8) | image[(address + 1) & 0xFFF]);
+        }
+
+        std::fill(m_Written.begin(), m_Written.end(), 0);
+
+        std::fill(m_Display.begin(), m_Display.end(), 0);
+
+        //Reset the registers the same way a fresh Registers is initialized
+        Registers registers;
+
+        std::fill(m_ProgramCounter.begin(), m_ProgramCounter.end(), registers.ProgramCounter);
+        std::fill(m_Index.begin(), m_Index.end(), registers.Index);
+        for (std::vector<word>& stack : m_Stack)
+        {
+            std::fill(stack.begin(), stack.end(), 0);
+        }
+        std::fill(m_StackPointer.begin(), m_StackPointer.end(), registers.StackPointer);
+        std::fill(m_DelayTimer.begin(), m_DelayTimer.end(), registers.DelayTimer);
+        std::fill(m_SoundTimer.begin(), m_SoundTimer.end(), registers.SoundTimer);
+        for (std::vector<byte>& variable : m_Variable)
+        {
+            std::fill(variable.begin(), variable.end(), 0);
+        }
+
+        std::fill(m_Remaining.begin(), m_Remaining.end(), 0);
+    }
+
+    void LockstepEmulator::Execute(std::uint64_t cycles)
+    {
+        while (cycles > 0)
+        {
+            word budget = (word)std::min<std::uint64_t>(cycles, MaximumBudget);
+            cycles -= budget;
+
+            std::fill(m_Remaining.begin(), m_Remaining.begin() + m_Count, budget);
+
+            //Lanes that are ahead wait for the ones behind them, until every lane used up its budget
+            while (FormGroup())
+            {
+                RunGroup();
+            }
+        }
+    }
+
+    void LockstepEmulator::TickTimers()
+    {
+        const LaneVector one = LaneVector::Broadcast(1);
+
+        for (std::size_t lane = 0; lane < m_LaneCount; lane += LaneVector::Width)
+        {
+            //Timers stop at zero
+            LaneVector::SaturatingSubtract(LaneVector::Load(&m_DelayTimer[lane]), one).Store(&m_DelayTimer[lane]);
+            LaneVector::SaturatingSubtract(LaneVector::Load(&m_SoundTimer[lane]), one).Store(&m_SoundTimer[lane]);
+        }
+    }
+
+    Registers LockstepEmulator::GetRegisters(std::size_t instance) const
+    {
+        Registers registers;
+
+        registers.ProgramCounter = m_ProgramCounter[instance];
+        registers.Index = m_Index[instance];
+        for (byte i = 0; i < MaximumStackCount; i++)
+        {
+            registers.Stack[i] = m_Stack[i][instance];
+        }
+        registers.StackPointer = m_StackPointer[instance];
+        registers.DelayTimer = m_DelayTimer[instance];
+        registers.SoundTimer = m_SoundTimer[instance];
+        for (byte i = 0; i <= 0xF; i++)
+        {
+            registers.Variable[i] = m_Variable[i][instance];
+        }
+
+        return registers;
+    }
+
+    bool LockstepEmulator::FormGroup()
+    {
+        const WordVector none = WordVector::Broadcast(NoProgramCounter);
+        const WordVector zero = WordVector::Broadcast(0);
+
+        //Find the lowest address of the lanes that still have instructions left
+        WordVector lowest = none;
+
+        for (std::size_t lane = 0; lane < m_LaneCount; lane += WordVector::Width)
+        {
+            WordVector done = WordVector::Equal(WordVector::Load(&m_Remaining[lane]), zero);
+            lowest = WordVector::Minimum(lowest, WordVector::Select(done, none, WordVector::Load(&m_ProgramCounter[lane])));
+        }
+
+        word programCounter = lowest.Smallest();
+
+        if (programCounter == NoProgramCounter)
+        {
+            return false;
+        }
+
+        //Every lane at that address joins the group
+        const WordVector address = WordVector::Broadcast(programCounter);
+
+        WordVector others = none;
+        WordVector budget = none;
+        std::size_t first = m_LaneCount;
+        std::size_t last = 0;
+
+        for (std::size_t lane = 0; lane < m_LaneCount; lane += WordVector::Width)
+        {
+            WordVector remaining = WordVector::Load(&m_Remaining[lane]);
+            WordVector waiting = WordVector::Select(WordVector::Equal(remaining, zero), none, WordVector::Load(&m_ProgramCounter[lane]));
+            WordVector active = WordVector::Equal(waiting, address);
+
+            active.Store(&m_ActiveWords[lane]);
+
+            others = WordVector::Minimum(others, WordVector::Select(active, none, waiting));
+            budget = WordVector::Minimum(budget, WordVector::Select(active, remaining, none));
+
+            if (WordVector::Any(active))
+            {
+                first = std::min(first, lane);
+                last = lane + WordVector::Width;
+            }
+        }
+
+        //Only the vectors holding lanes of the group are visited while it runs
+        m_Group.ProgramCounter = programCounter;
+        m_Group.Budget = budget.Smallest();
+        m_Group.Others = others.Smallest();
+        m_Group.Begin = first / LaneVector::Width * LaneVector::Width;
+        m_Group.End = (last + LaneVector::Width - 1) / LaneVector::Width * LaneVector::Width;
+
+        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+        {
+            LaneVector::Narrow(&m_ActiveWords[lane]).Store(&m_Active[lane]);
+        }
+
+        return true;
+    }
+
+    void LockstepEmulator::RunGroup()
+    {
+        word programCounter = m_Group.ProgramCounter;
+        word executed = 0;
+
+        while (executed < m_Group.Budget)
+        {
+            word address = programCounter & 0xFFF;
+            word next = (address + 1) & 0xFFF;
+
+            Instruction instruction;
+
+            if (!(m_Written[address] | m_Written[next]))
+            {
+                instruction = m_DecodedInstructions[address];
+            }
+            else
+            {
+                //Instances may have written different code here, they only go on together if they all fetched the same instruction
+                word opcode = 0;
+                bool shared = true;
+                bool found = false;
+
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane++)
+                {
+                    if (m_Active[lane])
+                    {
+                        const byte* memory = &m_Memory[lane * MemorySize];
+                        word fetched = ((word)memory[address] << 8) | memory[next];
+
+                        shared &= !found || fetched == opcode;
+                        opcode = fetched;
+                        found = true;
+                    }
+                }
+
+                if (!shared)
+                {
+                    LeaveGroup(programCounter, executed);
+                    StepLanes(nullptr);
+                    return;
+                }
+
+                instruction = Decode(opcode);
+            }
+
+            if (!ExecuteVector(instruction))
+            {
+                bool jumps = instruction.OpCode == 0x2 || instruction.OpCode == 0xB || (instruction.OpCode == 0x0 && instruction.NNN == 0x0EE);
+
+                //Lanes returning or jumping through a register can end up anywhere, the group is formed again after them
+                if (jumps)
+                {
+                    LeaveGroup(programCounter, executed);
+                    StepLanes(&instruction);
+                    return;
+                }
+
+                //Everything else executed lane by lane still leaves every lane at the next instruction
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane++)
+                {
+                    if (m_Active[lane])
+                    {
+                        ExecuteLane(lane, instruction);
+                    }
+                }
+            }
+
+            executed++;
+
+            switch (instruction.OpCode)
+            {
+                //JP addr
+                case 0x1:
+                {
+                    programCounter = instruction.NNN;
+                    break;
+                }
+
+                //The skips, and LD VX, K which stays on itself until the condition of a key being held holds
+                case 0x3:
+                case 0x4:
+                case 0x5:
+                case 0x9:
+                case 0xE:
+                case 0xF:
+                {
+                    if (instruction.OpCode == 0xF && instruction.NN != 0x0A)
+                    {
+                        programCounter = address + 2;
+                        break;
+                    }
+
+                    word passed = instruction.OpCode == 0xF ? address : address + 2;
+
+                    LaneVector any = LaneVector::Broadcast(0x00);
+                    LaneVector all = LaneVector::Broadcast(0xFF);
+
+                    for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                    {
+                        LaneVector active = LaneVector::Load(&m_Active[lane]);
+                        LaneVector condition = LaneVector::Load(&m_Condition[lane]);
+
+                        //Lanes outside the group neither skip nor keep the others from skipping
+                        any = any | (condition & active);
+                        all = all & (condition | (active ^ LaneVector::Broadcast(0xFF)));
+                    }
+
+                    if (LaneVector::All(all))
+                    {
+                        programCounter = passed + 2;
+                    }
+                    else if (LaneVector::Any(any))
+                    {
+                        //Only some of the lanes skip, so they go separate ways from here
+                        LeaveGroup(passed, executed);
+                        Skip();
+                        return;
+                    }
+                    else
+                    {
+                        programCounter = passed;
+                    }
+
+                    break;
+                }
+
+                default:
+                {
+                    programCounter = address + 2;
+                    break;
+                }
+            }
+
+            //Lanes waiting at a lower address go first, and lanes waiting at this one join the group
+            if (programCounter >= m_Group.Others)
+            {
+                break;
+            }
+        }
+
+        LeaveGroup(programCounter, executed);
+    }
+
+    void LockstepEmulator::LeaveGroup(word programCounter, word executed)
+    {
+        const WordVector address = WordVector::Broadcast(programCounter);
+        const WordVector count = WordVector::Broadcast(executed);
+
+        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += WordVector::Width)
+        {
+            WordVector active = WordVector::Load(&m_ActiveWords[lane]);
+
+            WordVector::Select(active, address, WordVector::Load(&m_ProgramCounter[lane])).Store(&m_ProgramCounter[lane]);
+            (WordVector::Load(&m_Remaining[lane]) - (active & count)).Store(&m_Remaining[lane]);
+        }
+    }
+
+    void LockstepEmulator::StepLanes(const Instruction* shared)
+    {
+        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane++)
+        {
+            if (!m_Active[lane])
+            {
+                continue;
+            }
+
+            if (shared)
+            {
+                ExecuteLane(lane, *shared);
+            }
+            else
+            {
+                //Fetch the lane's own code
+                const byte* memory = &m_Memory[lane * MemorySize];
+                word address = m_ProgramCounter[lane] & 0xFFF;
+
+                ExecuteLane(lane, Decode(((word)memory[address] << 8) | memory[(address + 1) & 0xFFF]));
+            }
+
+            m_Remaining[lane]--;
+        }
+    }
+
+    void LockstepEmulator::Skip()
+    {
+        const WordVector two = WordVector::Broadcast(2);
+
+        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += WordVector::Width)
+        {
+            WordVector active = WordVector::Load(&m_ActiveWords[lane]);
+            WordVector condition = WordVector::WidenMask(&m_Condition[lane]);
+
+            (WordVector::Load(&m_ProgramCounter[lane]) + (active & condition & two)).Store(&m_ProgramCounter[lane]);
+        }
+    }
+
+    bool LockstepEmulator::ExecuteVector(const Instruction& instruction)
+    {
+        byte x = instruction.X;
+        byte y = instruction.Y;
+
+        const LaneVector nn = LaneVector::Broadcast(instruction.NN);
+        const LaneVector one = LaneVector::Broadcast(1);
+
+        //Each vector loop only changes the active lanes, the others keep their old values
+        switch (instruction.OpCode)
+        {
+            //JP addr
+            case 0x1:
+            {
+                //Only the program counter changes
+                return true;
+            }
+
+            //SE VX, byte; SNE VX, byte; SE VX, VY; SNE VX, VY
+            case 0x3:
+            case 0x4:
+            case 0x5:
+            case 0x9:
+            {
+                //The skips that test for inequality flip the condition
+                const LaneVector invert = LaneVector::Broadcast((instruction.OpCode == 0x4 || instruction.OpCode == 0x9) ? 0xFF : 0x00);
+                bool registerOperand = instruction.OpCode == 0x5 || instruction.OpCode == 0x9;
+
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                {
+                    LaneVector vx = LaneVector::Load(&m_Variable[x][lane]);
+                    LaneVector operand = registerOperand ? LaneVector::Load(&m_Variable[y][lane]) : nn;
+
+                    (LaneVector::Equal(vx, operand) ^ invert).Store(&m_Condition[lane]);
+                }
+
+                return true;
+            }
+
+            //LD VX, byte
+            case 0x6:
+            {
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                {
+                    LaneVector active = LaneVector::Load(&m_Active[lane]);
+                    LaneVector vx = LaneVector::Load(&m_Variable[x][lane]);
+
+                    LaneVector::Select(active, nn, vx).Store(&m_Variable[x][lane]);
+                }
+
+                return true;
+            }
+
+            //ADD VX, byte
+            case 0x7:
+            {
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                {
+                    LaneVector active = LaneVector::Load(&m_Active[lane]);
+                    LaneVector vx = LaneVector::Load(&m_Variable[x][lane]);
+
+                    LaneVector::Select(active, vx + nn, vx).Store(&m_Variable[x][lane]);
+                }
+
+                return true;
+            }
+
+            case 0x8:
+            {
+                //Unknown 8XYN instructions do nothing but advance
+                if (instruction.N > 0x7 && instruction.N != 0xE)
+                {
+                    return true;
+                }
+
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                {
+                    LaneVector active = LaneVector::Load(&m_Active[lane]);
+                    LaneVector vx = LaneVector::Load(&m_Variable[x][lane]);
+                    LaneVector vy = LaneVector::Load(&m_Variable[y][lane]);
+                    LaneVector vf = LaneVector::Load(&m_Variable[0xF][lane]);
+
+                    LaneVector result = vx;
+                    LaneVector flag = vf;
+
+                    switch (instruction.N)
+                    {
+                        //LD VX, VY
+                        case 0x0: result = vy; break;
+
+                        //OR VX, VY
+                        case 0x1: result = vx | vy; break;
+
+                        //AND VX, VY
+                        case 0x2: result = vx & vy; break;
+
+                        //XOR VX, VY
+                        case 0x3: result = vx ^ vy; break;
+
+                        //ADD VX, VY, the sum wrapped around if it's smaller than VX
+                        case 0x4: result = vx + vy; flag = LaneVector::GreaterThan(vx, result) & one; break;
+
+                        //SUB VX, VY
+                        case 0x5: result = vx - vy; flag = LaneVector::GreaterThan(vx, vy) & one; break;
+
+                        //SHR VX {, VY}
+                        case 0x6: result = LaneVector::ShiftRight1(vx); flag = vx & one; break;
+
+                        //SUBN VX, VY
+                        case 0x7: result = vy - vx; flag = LaneVector::GreaterThan(vy, vx) & one; break;
+
+                        //SHL VX {, VY}
+                        case 0xE: result = vx + vx; flag = LaneVector::ShiftRight7(vx); break;
+                    }
+
+                    //VF is written before VX, so VX wins when X is F
+                    LaneVector::Select(active, flag, vf).Store(&m_Variable[0xF][lane]);
+                    LaneVector::Select(active, result, vx).Store(&m_Variable[x][lane]);
+                }
+
+                return true;
+            }
+
+            //SKP VX; SKNP VX
+            case 0xE:
+            {
+                //There are no variable shifts of 8-bit lanes, so the keys are tested lane by lane.
+                //Unknown EXNN instructions never skip
+                byte pressed = instruction.NN == 0x9E ? 0x01 : 0x00;
+                byte released = instruction.NN == 0xA1 ? 0x01 : 0x00;
+
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane++)
+                {
+                    byte keyPressed = (m_Keys[lane] >> (m_Variable[x][lane] & 0xF)) & 0x1;
+                    m_Condition[lane] = -((keyPressed & pressed) | (!keyPressed & released));
+                }
+
+                return true;
+            }
+
+            //LD I, addr
+            case 0xA:
+            {
+                const WordVector nnn = WordVector::Broadcast(instruction.NNN);
+
+                for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += WordVector::Width)
+                {
+                    WordVector active = WordVector::Load(&m_ActiveWords[lane]);
+                    WordVector::Select(active, nnn, WordVector::Load(&m_Index[lane])).Store(&m_Index[lane]);
+                }
+
+                return true;
+            }
+
+            case 0xF:
+            {
+                std::vector<byte>& variable = m_Variable[x];
+
+                switch (instruction.NN)
+                {
+                    //LD VX, DT
+                    case 0x07:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                        {
+                            LaneVector active = LaneVector::Load(&m_Active[lane]);
+                            LaneVector::Select(active, LaneVector::Load(&m_DelayTimer[lane]), LaneVector::Load(&variable[lane])).Store(&variable[lane]);
+                        }
+
+                        return true;
+                    }
+
+                    //LD VX, K, the condition is whether a key is held down and the caller keeps the lanes without one waiting
+                    case 0x0A:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane++)
+                        {
+                            word keys = m_Keys[lane];
+                            m_Condition[lane] = keys != 0 ? 0xFF : 0x00;
+
+                            if (m_Active[lane] && keys != 0)
+                            {
+                                byte key = 0;
+                                while (!((keys >> key) & 0x1))
+                                {
+                                    key++;
+                                }
+
+                                variable[lane] = key;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    //LD DT, VX
+                    case 0x15:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                        {
+                            LaneVector active = LaneVector::Load(&m_Active[lane]);
+                            LaneVector::Select(active, LaneVector::Load(&variable[lane]), LaneVector::Load(&m_DelayTimer[lane])).Store(&m_DelayTimer[lane]);
+                        }
+
+                        return true;
+                    }
+
+                    //LD ST, VX
+                    case 0x18:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += LaneVector::Width)
+                        {
+                            LaneVector active = LaneVector::Load(&m_Active[lane]);
+                            LaneVector::Select(active, LaneVector::Load(&variable[lane]), LaneVector::Load(&m_SoundTimer[lane])).Store(&m_SoundTimer[lane]);
+                        }
+
+                        return true;
+                    }
+
+                    //ADD I, VX
+                    case 0x1E:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += WordVector::Width)
+                        {
+                            WordVector active = WordVector::Load(&m_ActiveWords[lane]);
+                            (WordVector::Load(&m_Index[lane]) + (active & WordVector::Widen(&variable[lane]))).Store(&m_Index[lane]);
+                        }
+
+                        return true;
+                    }
+
+                    //LD F, VX
+                    case 0x29:
+                    {
+                        for (std::size_t lane = m_Group.Begin; lane < m_Group.End; lane += WordVector::Width)
+                        {
+                            WordVector active = WordVector::Load(&m_ActiveWords[lane]);
+                            WordVector vx = WordVector::Widen(&variable[lane]);
+                            WordVector twice = vx + vx;
+
+                            WordVector::Select(active, twice + twice + vx, WordVector::Load(&m_Index[lane])).Store(&m_Index[lane]);
+                        }
+
+                        return true;
+                    }
+                }
+
+                break;
+            }
+        }
+
+        //Everything else touches memory, the stack or the display of each instance, so it runs lane by lane
+        return false;
+    }
+
+    void LockstepEmulator::ExecuteLane(std::size_t lane, const Instruction& instruction)
+    {
+        //The same semantics as Emulator, on the lane's slice of every register
+        byte* memory = &m_Memory[lane * MemorySize];
+        std::uint64_t* display = &m_Display[lane * DisplayHeight];
+
+        word& programCounter = m_ProgramCounter[lane];
+        word& index = m_Index[lane];
+        sbyte& stackPointer = m_StackPointer[lane];
+
+        byte x = instruction.X;
+        byte y = instruction.Y;
+        byte nn = instruction.NN;
+        word nnn = instruction.NNN;
+
+        byte& vx = m_Variable[x][lane];
+        byte& vf = m_Variable[0xF][lane];
+        byte vy = m_Variable[y][lane];
+
+        programCounter = (programCounter & 0xFFF) + 2;
+
+        switch (instruction.OpCode)
+        {
+            case 0x0:
+            {
+                //CLS
+                if (nnn == 0x0E0)
+                {
+                    memset(display, 0, DisplayHeight * sizeof(std::uint64_t));
+                }
+                //RET
+                else if (nnn == 0x0EE && stackPointer >= 0)
+                {
+                    programCounter = m_Stack[stackPointer][lane];
+                    stackPointer--;
+                }
+
+                break;
+            }
+
+            //JP addr
+            case 0x1: programCounter = nnn; break;
+
+            //CALL addr
+            case 0x2:
+            {
+                if (stackPointer >= MaximumStackCount - 1)
+                {
+                    break;
+                }
+
+                stackPointer++;
+                m_Stack[stackPointer][lane] = programCounter;
+                programCounter = nnn;
+
+                break;
+            }
+
+            //SE VX, byte
+            case 0x3: programCounter += (vx == nn) * 2; break;
+
+            //SNE VX, byte
+            case 0x4: programCounter += (vx != nn) * 2; break;
+
+            //SE VX, VY
+            case 0x5: programCounter += (vx == vy) * 2; break;
+
+            //LD VX, byte
+            case 0x6: vx = nn; break;
+
+            //ADD VX, byte
+            case 0x7: vx += nn; break;
+
+            case 0x8:
+            {
+                byte value = vx;
+
+                switch (instruction.N)
+                {
+                    case 0x0: vx = vy; break;
+                    case 0x1: vx = value | vy; break;
+                    case 0x2: vx = value & vy; break;
+                    case 0x3: vx = value ^ vy; break;
+                    case 0x4: vf = (value + vy) > 0xFF; vx = value + vy; break;
+                    case 0x5: vf = value > vy; vx = value - vy; break;
+                    case 0x6: vf = value & 0x01; vx = value / 2; break;
+                    case 0x7: vf = vy > value; vx = vy - value; break;
+                    case 0xE: vf = (value >> 7) & 0x01; vx = value * 2; break;
+                }
+
+                break;
+            }
+
+            //SNE VX, VY
+            case 0x9: programCounter += (vx != vy) * 2; break;
+
+            //LD I, addr
+            case 0xA: index = nnn; break;
+
+            //JP V0, addr
+            case 0xB: programCounter = m_Variable[0x0][lane] + nnn; break;
+
+            //RND VX, byte
+            case 0xC:
+            {
+                //Each lane has its own generator so instances stay reproducible
+                vx = m_Random[lane].Next() & nn;
+
+                break;
+            }
+
+            //DRAW VX, VY, nibble
+            case 0xD:
+            {
+                byte column = vx % DisplayWidth;
+                byte row = vy % DisplayHeight;
+
+                std::uint64_t collision = 0;
+
+                for (byte i = 0; i < instruction.N; i++)
+                {
+                    std::uint64_t sprite = (std::uint64_t)memory[(index + i) & 0xFFF] << (DisplayWidth - 8);
+                    sprite = (sprite >> column) | (sprite << ((DisplayWidth - column) % DisplayWidth));
+
+                    std::uint64_t& line = display[(row + i) % DisplayHeight];
+                    collision |= line & sprite;
+                    line ^= sprite;
+                }
+
+                vf = collision != 0;
+
+                break;
+            }
+
+            case 0xE:
+            {
+                bool keyPressed = (m_Keys[lane] >> (vx & 0xF)) & 0x1;
+
+                //SKP VX
+                if (nn == 0x9E)
+                {
+                    programCounter += keyPressed * 2;
+                }
+                //SKNP VX
+                else if (nn == 0xA1)
+                {
+                    programCounter += (!keyPressed) * 2;
+                }
+
+                break;
+            }
+
+            case 0xF:
+            {
+                switch (nn)
+                {
+                    //LD VX, DT
+                    case 0x07: vx = m_DelayTimer[lane]; break;
+
+                    //LD VX, K
+                    case 0x0A:
+                    {
+                        word keys = m_Keys[lane];
+
+                        //Wait on this instruction until a key is held down
+                        if (keys == 0)
+                        {
+                            programCounter -= 2;
+                            break;
+                        }
+
+                        byte key = 0;
+                        while (!((keys >> key) & 0x1))
+                        {
+                            key++;
+                        }
+
+                        vx = key;
+
+                        break;
+                    }
+
+                    //LD DT, VX
+                    case 0x15: m_DelayTimer[lane] = vx; break;
+
+                    //LD ST, VX
+                    case 0x18: m_SoundTimer[lane] = vx; break;
+
+                    //ADD I, VX
+                    case 0x1E: index += vx; break;
+
+                    //LD F, VX
+                    case 0x29: index = 5 * vx; break;
+
+                    //LD B, VX
+                    case 0x33:
+                    {
+                        byte value = vx;
+
+                        memory[(index + 2) & 0xFFF] = value % 10;
+                        memory[(index + 1) & 0xFFF] = (value / 10) % 10;
+                        memory[(index + 0) & 0xFFF] = (value / 100) % 10;
+
+                        //The shared decoded instructions no longer hold for these addresses
+                        m_Written[(index + 2) & 0xFFF] = 1;
+                        m_Written[(index + 1) & 0xFFF] = 1;
+                        m_Written[(index + 0) & 0xFFF] = 1;
+
+                        break;
+                    }
+
+                    //LD [I], VX
+                    case 0x55:
+                    {
+                        for (byte i = 0; i <= x; i++)
+                        {
+                            memory[(index + i) & 0xFFF] = m_Variable[i][lane];
+                            m_Written[(index + i) & 0xFFF] = 1;
+                        }
+
+                        break;
+                    }
+
+                    //LD VX, [I]
+                    case 0x65:
+                    {
+                        for (byte i = 0; i <= x; i++)
+                        {
+                            m_Variable[i][lane] = memory[(index + i) & 0xFFF];
+                        }
+
+                        break;
+                    }
+                }
+
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/Instruction.h"
+#include "Emulator/Random.h"
+#include "Emulator/Registers.h"
+
+namespace CHIP8
+{
+    //Runs many instances of the same machine side by side, every instance executing the same number of instructions.
+    //Every register is stored as an array with one lane per instance, so instances executing the same
+    //instruction are updated together with vector instructions. When instances branch apart, the group of
+    //lanes at the lowest address runs while the others wait, so the lanes that fell behind catch up and join
+    //the others again wherever their paths meet. Instances always behave like the modern quirk profile of Emulator.
+    class LockstepEmulator
+    {
+    public:
+        LockstepEmulator(std::size_t count, std::uint32_t seed = 0);
+        ~LockstepEmulator();
+
+        //Resets every instance and loads the same program at 0x200
+        void LoadProgram(const byte* program, std::size_t size);
+
+        //Sets the keys held down by an instance, bit N is key N
+        void SetKeys(std::size_t instance, word keys) { m_Keys[instance] = keys; }
+
+        //Executes the given number of instructions on every instance
+        void Execute(std::uint64_t cycles);
+
+        //Counts the delay and sound timers of every instance down by one
+        void TickTimers();
+
+        std::size_t GetCount() const { return m_Count; }
+
+        //Gathers the registers of a single instance
+        Registers GetRegisters(std::size_t instance) const;
+
+        //The display of a single instance, in the layout of the low resolution screen of Emulator
+        const std::uint64_t* GetDisplay(std::size_t instance) const { return &m_Display[instance * DisplayHeight]; }
+
+        const byte* GetMemory(std::size_t instance) const { return &m_Memory[instance * MemorySize]; }
+
+    private:
+        static constexpr byte MaximumStackCount = Registers::MaximumStackCount;
+
+        static constexpr byte DisplayWidth = 64;
+        static constexpr byte DisplayHeight = 32;
+
+        static constexpr std::size_t MemorySize = 0xFFF + 1;
+
+        //How many instructions every instance executes before the groups are formed again from scratch,
+        //small enough for the instructions left to fit the signed 16-bit lanes
+        static constexpr word MaximumBudget = 0x4000;
+
+        //Above every address a lane can be at, for the lanes that have nothing left to execute
+        static constexpr word NoProgramCounter = 0x7FFF;
+
+        //The lanes currently executing together, all at the same address
+        struct Group
+        {
+            word ProgramCounter;
+
+            //The fewest instructions any of them has left
+            word Budget;
+
+            //The lowest address of the lanes outside the group, it stops once it gets there or past it
+            word Others;
+
+            //The lanes of the group are within these, rounded to whole vectors
+            std::size_t Begin;
+            std::size_t End;
+        };
+
+        std::size_t m_Count;
+
+        //The number of lanes, rounded up to a whole number of vectors
+        std::size_t m_LaneCount;
+
+        //The registers, one array per register with one lane per instance
+        std::vector<word> m_ProgramCounter;
+        std::vector<word> m_Index;
+        std::vector<word> m_Stack[MaximumStackCount];
+        std::vector<sbyte> m_StackPointer;
+        std::vector<byte> m_DelayTimer;
+        std::vector<byte> m_SoundTimer;
+        std::vector<byte> m_Variable[0xF + 1];
+
+        std::vector<word> m_Keys;
+        std::vector<Random> m_Random;
+
+        //The memory and display of every instance, one after the other
+        std::vector<byte> m_Memory;
+        std::vector<std::uint64_t> m_Display;
+
+        //The loaded program decoded once for every instance, and the addresses any instance has written to since
+        std::vector<Instruction> m_DecodedInstructions;
+        std::vector<byte> m_Written;
+
+        //The instructions each lane still has to execute in the current call to Execute(), always 0 for the padding lanes
+        std::vector<word> m_Remaining;
+
+        Group m_Group;
+
+        //0xFF for the lanes of the group, 0x00 for the others, and the same as 16-bit masks
+        std::vector<byte> m_Active;
+        std::vector<word> m_ActiveWords;
+
+        //0xFF for the lanes whose skip condition held
+        std::vector<byte> m_Condition;
+
+        //Gathers the lanes at the lowest address that still have instructions left into the group.
+        //Returns false once every lane is done
+        bool FormGroup();
+
+        //Executes instructions on the group until it splits up, reaches the other lanes or runs out of instructions
+        void RunGroup();
+
+        //Stores the address the group is at in its lanes, and takes the instructions executed off their budgets
+        void LeaveGroup(word programCounter, word executed);
+
+        //Executes a single instruction on every lane of the group on its own, after it left the group
+        void StepLanes(const Instruction* shared);
+
+        //Executes the registers part of an instruction on every active lane at once, the program counter is left to the caller.
+        //Returns false if the instruction has to be executed lane by lane instead
+        bool ExecuteVector(const Instruction& instruction);
+
+        //Executes one instruction on a single lane, including the fetch
+        void ExecuteLane(std::size_t lane, const Instruction& instruction);
+
+        //Skips the next instruction on every active lane whose condition is set
+        void Skip();
+    };
+}
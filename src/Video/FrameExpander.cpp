@@ -0,0 +1,337 @@
+#include "Video/FrameExpander.h"
+
+#include <cstring>
+
+//Pick the widest vector instructions the compiler is allowed to use
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CHIP8_VIDEO_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CHIP8_VIDEO_SSE2
+#endif
+
+namespace CHIP8
+{
+    namespace
+    {
+        //The bytes of a vector, widened pixels are stored this many bytes at a time
+    #if defined(CHIP8_VIDEO_AVX2)
+        constexpr std::size_t VectorSize = 32;
+    #elif defined(CHIP8_VIDEO_SSE2)
+        constexpr std::size_t VectorSize = 16;
+    #endif
+
+        //The bits of a row, the left and the right column of a plane as one 128 pixel row
+        struct RowBits
+        {
+            std::uint64_t Columns[2];
+
+            //The count pixels starting at x, which doesn't cross a column, with the leftmost in bit count - 1
+            std::uint32_t Get(byte x, byte count) const
+            {
+                std::uint64_t column = Columns[x / 64];
+                return (std::uint32_t)((column >> (64 - count - (x & 0x3F))) & ((std::uint64_t(1) << count) - 1));
+            }
+        };
+
+    #if !defined(CHIP8_VIDEO_AVX2) && !defined(CHIP8_VIDEO_SSE2)
+        //The color index of a pixel, from its bits in both planes
+        byte GetIndex(const RowBits& plane0, const RowBits& plane1, byte x)
+        {
+            return (byte)(plane0.Get(x, 1) | (plane1.Get(x, 1) << 1));
+        }
+    #endif
+
+        //Writes width RGBA pixels. Every pixel is picked without a branch as
+        //c0 ^ (bit0 & (c0 ^ c1)) ^ (bit1 & (c0 ^ c2)) ^ (bit0 & bit1 & (c0 ^ c1 ^ c2 ^ c3)), with the bits as masks
+        void ExpandRgba(const RowBits& plane0, const RowBits& plane1, byte width, const std::uint32_t* colors, byte* pixels)
+        {
+        #if defined(CHIP8_VIDEO_AVX2)
+            //8 pixels of 4 bytes per vector, one byte of each plane
+            const __m256i select = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+            const __m256i color0 = _mm256_set1_epi32((int)colors[0]);
+            const __m256i delta1 = _mm256_set1_epi32((int)(colors[0] ^ colors[1]));
+            const __m256i delta2 = _mm256_set1_epi32((int)(colors[0] ^ colors[2]));
+            const __m256i delta3 = _mm256_set1_epi32((int)(colors[0] ^ colors[1] ^ colors[2] ^ colors[3]));
+
+            for (byte x = 0; x < width; x += 8)
+            {
+                __m256i mask0 = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)plane0.Get(x, 8)), select), select);
+                __m256i mask1 = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)plane1.Get(x, 8)), select), select);
+
+                __m256i value = _mm256_xor_si256(color0, _mm256_and_si256(mask0, delta1));
+                value = _mm256_xor_si256(value, _mm256_and_si256(mask1, delta2));
+                value = _mm256_xor_si256(value, _mm256_and_si256(_mm256_and_si256(mask0, mask1), delta3));
+
+                _mm256_storeu_si256((__m256i*)(pixels + x * 4), value);
+            }
+        #elif defined(CHIP8_VIDEO_SSE2)
+            //4 pixels of 4 bytes per vector, the high and the low half of a byte of each plane
+            const __m128i selectHigh = _mm_setr_epi32(0x80, 0x40, 0x20, 0x10);
+            const __m128i selectLow = _mm_setr_epi32(0x08, 0x04, 0x02, 0x01);
+            const __m128i color0 = _mm_set1_epi32((int)colors[0]);
+            const __m128i delta1 = _mm_set1_epi32((int)(colors[0] ^ colors[1]));
+            const __m128i delta2 = _mm_set1_epi32((int)(colors[0] ^ colors[2]));
+            const __m128i delta3 = _mm_set1_epi32((int)(colors[0] ^ colors[1] ^ colors[2] ^ colors[3]));
+
+            for (byte x = 0; x < width; x += 8)
+            {
+                __m128i bits0 = _mm_set1_epi32((int)plane0.Get(x, 8));
+                __m128i bits1 = _mm_set1_epi32((int)plane1.Get(x, 8));
+
+                for (byte half = 0; half < 2; half++)
+                {
+                    __m128i select = half == 0 ? selectHigh : selectLow;
+                    __m128i mask0 = _mm_cmpeq_epi32(_mm_and_si128(bits0, select), select);
+                    __m128i mask1 = _mm_cmpeq_epi32(_mm_and_si128(bits1, select), select);
+
+                    __m128i value = _mm_xor_si128(color0, _mm_and_si128(mask0, delta1));
+                    value = _mm_xor_si128(value, _mm_and_si128(mask1, delta2));
+                    value = _mm_xor_si128(value, _mm_and_si128(_mm_and_si128(mask0, mask1), delta3));
+
+                    _mm_storeu_si128((__m128i*)(pixels + x * 4 + half * 16), value);
+                }
+            }
+        #else
+            for (byte x = 0; x < width; x++)
+            {
+                memcpy(pixels + x * 4, &colors[GetIndex(plane0, plane1, x)], 4);
+            }
+        #endif
+        }
+
+        //Writes width gray pixels, picked the same way as the RGBA ones
+        void ExpandGray(const RowBits& plane0, const RowBits& plane1, byte width, const byte* colors, byte* pixels)
+        {
+        #if defined(CHIP8_VIDEO_AVX2)
+            //32 pixels per vector, each of the 4 bytes of a plane spread over 8 lanes
+            const __m256i spread = _mm256_setr_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+                1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i select = _mm256_set1_epi64x((long long)0x0102040810204080);
+            const __m256i color0 = _mm256_set1_epi8((char)colors[0]);
+            const __m256i delta1 = _mm256_set1_epi8((char)(colors[0] ^ colors[1]));
+            const __m256i delta2 = _mm256_set1_epi8((char)(colors[0] ^ colors[2]));
+            const __m256i delta3 = _mm256_set1_epi8((char)(colors[0] ^ colors[1] ^ colors[2] ^ colors[3]));
+
+            for (byte x = 0; x < width; x += 32)
+            {
+                __m256i mask0 = _mm256_shuffle_epi8(_mm256_set1_epi32((int)plane0.Get(x, 32)), spread);
+                __m256i mask1 = _mm256_shuffle_epi8(_mm256_set1_epi32((int)plane1.Get(x, 32)), spread);
+                mask0 = _mm256_cmpeq_epi8(_mm256_and_si256(mask0, select), select);
+                mask1 = _mm256_cmpeq_epi8(_mm256_and_si256(mask1, select), select);
+
+                __m256i value = _mm256_xor_si256(color0, _mm256_and_si256(mask0, delta1));
+                value = _mm256_xor_si256(value, _mm256_and_si256(mask1, delta2));
+                value = _mm256_xor_si256(value, _mm256_and_si256(_mm256_and_si256(mask0, mask1), delta3));
+
+                _mm256_storeu_si256((__m256i*)(pixels + x), value);
+            }
+        #elif defined(CHIP8_VIDEO_SSE2)
+            //16 pixels per vector, each of the 2 bytes of a plane spread over 8 lanes
+            const __m128i select = _mm_set1_epi64x((long long)0x0102040810204080);
+            const __m128i color0 = _mm_set1_epi8((char)colors[0]);
+            const __m128i delta1 = _mm_set1_epi8((char)(colors[0] ^ colors[1]));
+            const __m128i delta2 = _mm_set1_epi8((char)(colors[0] ^ colors[2]));
+            const __m128i delta3 = _mm_set1_epi8((char)(colors[0] ^ colors[1] ^ colors[2] ^ colors[3]));
+
+            for (byte x = 0; x < width; x += 16)
+            {
+                std::uint32_t bits0 = plane0.Get(x, 16);
+                std::uint32_t bits1 = plane1.Get(x, 16);
+
+                __m128i mask0 = _mm_unpacklo_epi64(_mm_set1_epi8((char)(bits0 >> 8)), _mm_set1_epi8((char)bits0));
+                __m128i mask1 = _mm_unpacklo_epi64(_mm_set1_epi8((char)(bits1 >> 8)), _mm_set1_epi8((char)bits1));
+                mask0 = _mm_cmpeq_epi8(_mm_and_si128(mask0, select), select);
+                mask1 = _mm_cmpeq_epi8(_mm_and_si128(mask1, select), select);
+
+                __m128i value = _mm_xor_si128(color0, _mm_and_si128(mask0, delta1));
+                value = _mm_xor_si128(value, _mm_and_si128(mask1, delta2));
+                value = _mm_xor_si128(value, _mm_and_si128(_mm_and_si128(mask0, mask1), delta3));
+
+                _mm_storeu_si128((__m128i*)(pixels + x), value);
+            }
+        #else
+            for (byte x = 0; x < width; x++)
+            {
+                pixels[x] = colors[GetIndex(plane0, plane1, x)];
+            }
+        #endif
+        }
+
+    #if defined(CHIP8_VIDEO_AVX2) || defined(CHIP8_VIDEO_SSE2)
+        //Fills a vector with copies of a pixel and stores it
+        template<std::size_t PixelSize>
+        void StoreRepeated(byte* pixels, const byte* pixel);
+    #endif
+
+    #if defined(CHIP8_VIDEO_AVX2)
+        template<> void StoreRepeated<4>(byte* pixels, const byte* pixel)
+        {
+            std::uint32_t value;
+            memcpy(&value, pixel, 4);
+            _mm256_storeu_si256((__m256i*)pixels, _mm256_set1_epi32((int)value));
+        }
+
+        template<> void StoreRepeated<1>(byte* pixels, const byte* pixel)
+        {
+            _mm256_storeu_si256((__m256i*)pixels, _mm256_set1_epi8((char)*pixel));
+        }
+    #elif defined(CHIP8_VIDEO_SSE2)
+        template<> void StoreRepeated<4>(byte* pixels, const byte* pixel)
+        {
+            std::uint32_t value;
+            memcpy(&value, pixel, 4);
+            _mm_storeu_si128((__m128i*)pixels, _mm_set1_epi32((int)value));
+        }
+
+        template<> void StoreRepeated<1>(byte* pixels, const byte* pixel)
+        {
+            _mm_storeu_si128((__m128i*)pixels, _mm_set1_epi8((char)*pixel));
+        }
+    #endif
+
+        //Repeats every pixel of a row scale times. A pixel is stored a vector at a time until its copies are covered,
+        //whatever spills over is overwritten by the next pixel. Only the pixels whose last vector would spill past
+        //the end of the row are copied one at a time
+        template<std::size_t PixelSize>
+        void Widen(const byte* row, byte width, byte scale, byte* pixels)
+        {
+            std::size_t span = scale * PixelSize;
+            byte x = 0;
+
+        #if defined(CHIP8_VIDEO_AVX2) || defined(CHIP8_VIDEO_SSE2)
+            std::size_t end = width * span;
+            std::size_t stores = (span + VectorSize - 1) / VectorSize;
+
+            for (; x < width && x * span + stores * VectorSize <= end; x++)
+            {
+                for (std::size_t store = 0; store < stores; store++)
+                {
+                    StoreRepeated<PixelSize>(pixels + x * span + store * VectorSize, row + x * PixelSize);
+                }
+            }
+        #endif
+
+            for (; x < width; x++)
+            {
+                for (byte copy = 0; copy < scale; copy++)
+                {
+                    memcpy(pixels + x * span + copy * PixelSize, row + x * PixelSize, PixelSize);
+                }
+            }
+        }
+    }
+
+    FrameExpander::FrameExpander(PixelFormat format, byte scale) : m_Format(format)
+    {
+        SetScale(scale);
+
+        SetColor(0, 0x000000FF);
+        SetColor(1, 0xFFFFFFFF);
+        SetColor(2, 0xFFFFFFFF);
+        SetColor(3, 0xFFFFFFFF);
+    }
+
+    void FrameExpander::SetColor(byte index, std::uint32_t rgba)
+    {
+        index &= 0x3;
+
+        byte red = (byte)(rgba >> 24);
+        byte green = (byte)(rgba >> 16);
+        byte blue = (byte)(rgba >> 8);
+        byte alpha = (byte)rgba;
+
+        //Kept in the order the bytes are written, whatever the byte order of the host
+        byte bytes[4] = { red, green, blue, alpha };
+        memcpy(&m_Rgba[index], bytes, 4);
+
+        //BT.601 luma
+        m_Gray[index] = (byte)((red * 77 + green * 150 + blue * 29 + 128) >> 8);
+
+        m_Valid = false;
+    }
+
+    void FrameExpander::SetScale(byte scale)
+    {
+        scale = scale < 1 ? 1 : scale;
+        scale = scale > MaximumScale ? MaximumScale : scale;
+
+        m_Valid &= scale == m_Scale;
+        m_Scale = scale;
+    }
+
+    std::uint64_t FrameExpander::Expand(const Display& display, byte* pixels, std::size_t pitch)
+    {
+        byte width = display.GetWidth();
+        byte height = display.GetHeight();
+        bool highResolution = display.IsHighResolution();
+
+        //Switching the resolution changes the size of every row
+        m_Valid &= highResolution == m_LastHighResolution;
+        m_LastHighResolution = highResolution;
+
+        std::size_t pixelSize = GetPixelSize();
+        std::size_t rowSize = width * m_Scale * pixelSize;
+        std::uint64_t written = 0;
+
+        for (byte row = 0; row < height; row++)
+        {
+            bool changed = !m_Valid;
+
+            for (byte plane = 0; plane < Display::PlaneCount; plane++)
+            {
+                //The right column is only on screen in high resolution
+                const Display::Plane& current = display.GetPlane(plane);
+                std::uint64_t right = highResolution ? current.Right[row] : 0;
+
+                changed |= current.Left[row] != m_Last[plane].Left[row] || right != m_Last[plane].Right[row];
+                m_Last[plane].Left[row] = current.Left[row];
+                m_Last[plane].Right[row] = right;
+            }
+
+            if (!changed)
+            {
+                continue;
+            }
+
+            RowBits plane0 = { { m_Last[0].Left[row], m_Last[0].Right[row] } };
+            RowBits plane1 = { { m_Last[1].Left[row], m_Last[1].Right[row] } };
+
+            //At 1x the row goes straight to the buffer, otherwise it is widened from the row kept here
+            byte* line = pixels + row * m_Scale * pitch;
+            byte* expanded = m_Scale == 1 ? line : m_Row;
+
+            if (m_Format == PixelFormat::Rgba)
+            {
+                ExpandRgba(plane0, plane1, width, m_Rgba, expanded);
+            }
+            else
+            {
+                ExpandGray(plane0, plane1, width, m_Gray, expanded);
+            }
+
+            if (m_Scale > 1)
+            {
+                if (m_Format == PixelFormat::Rgba)
+                {
+                    Widen<4>(m_Row, width, m_Scale, line);
+                }
+                else
+                {
+                    Widen<1>(m_Row, width, m_Scale, line);
+                }
+
+                for (byte copy = 1; copy < m_Scale; copy++)
+                {
+                    memcpy(line + copy * pitch, line, rowSize);
+                }
+            }
+
+            written |= std::uint64_t(1) << row;
+        }
+
+        m_Valid = true;
+        return written;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Base.h"
+#include "Emulator/Display.h"
+
+namespace CHIP8
+{
+    //The pixels a FrameExpander writes
+    enum class PixelFormat : byte
+    {
+        //4 bytes per pixel: red, green, blue and alpha
+        Rgba,
+
+        //1 byte per pixel
+        Gray
+    };
+
+    //Turns the display into pixels for a frontend or an encoder, scaled up by a whole factor from 1x to 16x.
+    //
+    //Every pixel takes one of four colors, picked by its bits in the two planes. A row of the display is expanded
+    //a vector of pixels at a time, widened to the scale with overlapping vector stores, then copied down into the
+    //rest of its scaled rows. The display of the last call is kept and only rows that differ from it are written,
+    //so the caller has to pass the same buffer every time, or call Invalidate() first
+    class FrameExpander
+    {
+    public:
+        static constexpr byte MaximumScale = 16;
+
+        FrameExpander(PixelFormat format = PixelFormat::Rgba, byte scale = 1);
+
+        //Sets the color of the pixels whose bits are the index, bit N is plane N. Colors are 0xRRGGBBAA, gray pixels
+        //take their luma. Index 0 starts out black, every other index white
+        void SetColor(byte index, std::uint32_t rgba);
+
+        //Clamped to 1x to MaximumScale
+        void SetScale(byte scale);
+        byte GetScale() const { return m_Scale; }
+
+        PixelFormat GetFormat() const { return m_Format; }
+        std::size_t GetPixelSize() const { return m_Format == PixelFormat::Rgba ? 4 : 1; }
+
+        //The size of the expanded display in pixels, it changes with the resolution
+        std::size_t GetWidth(const Display& display) const { return display.GetWidth() * m_Scale; }
+        std::size_t GetHeight(const Display& display) const { return display.GetHeight() * m_Scale; }
+
+        //Writes every row of the display that changed since the last call to a buffer of GetHeight() rows, pitch bytes
+        //apart. Returns the rows of the display that were written, bit N is row N, which covers rows N * scale up to
+        //(N + 1) * scale of the buffer
+        std::uint64_t Expand(const Display& display, byte* pixels, std::size_t pitch);
+
+        //Makes the next Expand() write every row, for a new buffer or one that was drawn over
+        void Invalidate() { m_Valid = false; }
+
+    private:
+        PixelFormat m_Format;
+        byte m_Scale = 1;
+
+        //The pixel of every color index, in the bytes of the format
+        std::uint32_t m_Rgba[4];
+        byte m_Gray[4];
+
+        //The display as of the last Expand(), only meaningful while valid
+        Display::Plane m_Last[Display::PlaneCount] = {};
+        bool m_LastHighResolution = false;
+        bool m_Valid = false;
+
+        //A single row of the display at 1x, widened from here for the larger scales
+        byte m_Row[Display::Width * 4];
+    };
+}
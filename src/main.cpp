@@ -1,10 +1,347 @@
-#include "Emulator/Emulator.h"
-
-int main(int argc, char** argv)
-{
-    auto emulator = new Emulator();
-    emulator->Run();
-    delete emulator;
-
-    return 0;
-}
\ No newline at end of file
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Audio/AudioBuffer.h"
+#include "Audio/AudioGenerator.h"
+#include "Audio/WavSink.h"
+#include "Batch/BatchRunner.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/KeypadQueue.h"
+#include "Emulator/Movie.h"
+#include "Emulator/RomCache.h"
+#include "Emulator/Scheduler.h"
+#include "Emulator/StackSampler.h"
+
+namespace
+{
+    //Runs every job of a manifest headless and writes their results
+    int RunBatch(int argc, char** argv)
+    {
+        std::string output;
+        std::string profile;
+        std::string stacks;
+        std::uint64_t stackInterval = CHIP8::StackSampler::DefaultInterval;
+        std::size_t threadCount = 0;
+        bool pinThreads = false;
+        CHIP8::ExecutionMode mode = CHIP8::ExecutionMode::Interpreter;
+
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            {
+                threadCount = std::strtoul(argv[++i], nullptr, 10);
+            }
+            else if (strcmp(argv[i], "--pin") == 0)
+            {
+                pinThreads = true;
+            }
+            else if (strcmp(argv[i], "--jit") == 0)
+            {
+                mode = CHIP8::ExecutionMode::Jit;
+            }
+            else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            {
+                output = argv[++i];
+            }
+            else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            {
+                profile = argv[++i];
+            }
+            else if (strcmp(argv[i], "--stacks") == 0 && i + 1 < argc)
+            {
+                stacks = argv[++i];
+            }
+            else if (strcmp(argv[i], "--stack-interval") == 0 && i + 1 < argc)
+            {
+                stackInterval = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+
+        if (!profile.empty() && !CHIP8::ExecutionProfiler::Enabled)
+        {
+            std::cerr << "--profile requires a build with CHIP8_ENABLE_PROFILER" << std::endl;
+            return 1;
+        }
+
+        CHIP8::BatchRunner runner;
+        std::string error;
+
+        if (!runner.LoadManifest(argv[2], error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        runner.SetExecutionMode(mode);
+
+        if (!stacks.empty())
+        {
+            runner.SetStackSampling(stackInterval);
+        }
+
+        runner.Run(threadCount, pinThreads);
+
+        if (!stacks.empty())
+        {
+            std::ofstream file(stacks);
+
+            if (!file)
+            {
+                std::cerr << "Could not open " << stacks << std::endl;
+                return 1;
+            }
+
+            runner.GetStacks().WriteCollapsed(file);
+        }
+
+        if (!profile.empty())
+        {
+            std::ofstream file(profile);
+
+            if (!file)
+            {
+                std::cerr << "Could not open " << profile << std::endl;
+                return 1;
+            }
+
+            //CSV if the file asks for it, JSON otherwise
+            bool csv = profile.size() >= 4 && profile.compare(profile.size() - 4, 4, ".csv") == 0;
+
+            if (csv)
+            {
+                runner.GetProfile().WriteCsv(file);
+            }
+            else
+            {
+                runner.GetProfile().WriteJson(file);
+            }
+        }
+
+        if (output.empty())
+        {
+            runner.WriteResults(std::cout);
+            return 0;
+        }
+
+        std::ofstream file(output);
+
+        if (!file)
+        {
+            std::cerr << "Could not open " << output << std::endl;
+            return 1;
+        }
+
+        runner.WriteResults(file);
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: " << argv[0] << " [rom] [--clock hz] [--turbo] [--seed N] [--quirks modern|vip|schip|xochip] [--keys [--key-log keys.txt] [--record movie.c8m] [--wav sound.wav]] | --batch <manifest> [--threads N] [--pin] [--jit] [--output results.csv] [--profile profile.json] [--stacks stacks.folded [--stack-interval N]]" << std::endl;
+            return 1;
+        }
+
+        return RunBatch(argc, argv);
+    }
+
+    std::shared_ptr<const CHIP8::Rom> rom;
+    std::uint32_t clockSpeed = CHIP8::Scheduler::DefaultClockSpeed;
+    bool turbo = false;
+    bool keys = false;
+    std::string keyLog;
+    std::string wav;
+    std::string movie;
+    std::uint32_t seed = 0;
+    CHIP8::QuirkProfile quirks = CHIP8::QuirkProfile::Modern;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clockSpeed = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--turbo") == 0)
+        {
+            turbo = true;
+        }
+        else if (strcmp(argv[i], "--keys") == 0)
+        {
+            keys = true;
+        }
+        else if (strcmp(argv[i], "--key-log") == 0 && i + 1 < argc)
+        {
+            keyLog = argv[++i];
+        }
+        else if (strcmp(argv[i], "--wav") == 0 && i + 1 < argc)
+        {
+            wav = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            movie = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc)
+        {
+            if (!CHIP8::ParseQuirkProfile(argv[++i], quirks))
+            {
+                std::cerr << "Unknown quirk profile " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (!rom)
+        {
+            rom = CHIP8::RomCache::Global().Load(argv[i]);
+
+            if (!rom)
+            {
+                std::cerr << "Could not open " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (!movie.empty() && !keys)
+    {
+        std::cerr << "--record requires --keys" << std::endl;
+        return 1;
+    }
+
+    //Without --keys the run never ends, so the file would never be finished
+    if (!wav.empty() && !keys)
+    {
+        std::cerr << "--wav requires --keys" << std::endl;
+        return 1;
+    }
+
+    auto emulator = std::make_unique<CHIP8::Emulator>(rom);
+    emulator->SetSeed(seed);
+    emulator->SetQuirks(quirks);
+
+    CHIP8::Scheduler scheduler(*emulator, clockSpeed);
+    scheduler.SetTurbo(turbo);
+
+    //The sound goes to a file as it's generated. Opened before the input thread starts, nothing can fail after that
+    auto audio = std::make_unique<CHIP8::AudioBuffer>();
+    CHIP8::AudioGenerator generator(*audio);
+    CHIP8::WavSink sink;
+
+    if (!wav.empty())
+    {
+        if (!sink.Open(wav, *audio, generator.GetSampleRate()))
+        {
+            std::cerr << "Could not open " << wav << std::endl;
+            return 1;
+        }
+
+        scheduler.SetAudioGenerator(&generator);
+    }
+
+    CHIP8::KeypadQueue queue;
+    std::vector<CHIP8::KeyEvent> log;
+    std::thread input;
+
+    //Every line of standard input is a key in hexadecimal and whether it goes down or up, the run ends with the input
+    if (keys)
+    {
+        scheduler.SetKeypadQueue(&queue, &log);
+
+        input = std::thread([&queue, &scheduler]()
+        {
+            std::string line;
+
+            while (std::getline(std::cin, line))
+            {
+                std::istringstream tokens(line);
+                unsigned int key = 0;
+                std::string state;
+
+                tokens >> std::hex >> key >> state;
+
+                if (tokens.fail() || key > 0xF || (state != "down" && state != "up") || !queue.Push((CHIP8::byte)key, state == "down"))
+                {
+                    std::cerr << "Dropped key event " << line << std::endl;
+                }
+            }
+
+            scheduler.Stop();
+        });
+    }
+
+    scheduler.Run();
+
+    if (input.joinable())
+    {
+        input.join();
+    }
+
+    sink.Close();
+
+    if (audio->GetDropped() > 0)
+    {
+        std::cerr << "Dropped " << audio->GetDropped() << " audio samples" << std::endl;
+    }
+
+    //Plays the run again with --batch, exactly
+    if (!movie.empty())
+    {
+        CHIP8::Movie recording;
+        recording.RomHash = rom ? rom->GetHash() : 0;
+        recording.Seed = seed;
+        recording.ClockSpeed = scheduler.GetClockSpeed();
+        recording.Quirks = quirks;
+        recording.Cycles = scheduler.GetCycles();
+        recording.Events = log;
+
+        if (!recording.Save(movie))
+        {
+            std::cerr << "Could not write " << movie << std::endl;
+            return 1;
+        }
+    }
+
+    //The log is an input script for --batch that replays the run
+    if (!keyLog.empty())
+    {
+        std::ofstream file(keyLog);
+
+        if (!file)
+        {
+            std::cerr << "Could not open " << keyLog << std::endl;
+            return 1;
+        }
+
+        for (const CHIP8::KeyEvent& event : log)
+        {
+            file << event.Cycle << ' ' << std::hex << (int)event.Key << std::dec << ' ' << (event.Pressed ? "down" : "up") << '\n';
+        }
+    }
+
+    return 0;
+}
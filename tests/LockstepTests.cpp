@@ -0,0 +1,198 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Emulator/Emulator.h"
+#include "Lockstep/LockstepEmulator.h"
+
+namespace
+{
+    using namespace CHIP8;
+
+    constexpr std::uint32_t Seed = 0x1234;
+
+    int failures = 0;
+
+    void Check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    //Whether an instance of the lockstep emulator is in the same state as an Emulator that ran the same program
+    bool Matches(const LockstepEmulator& lockstep, std::size_t instance, const Emulator& emulator)
+    {
+        const Registers& expected = emulator.GetRegisters();
+        Registers registers = lockstep.GetRegisters(instance);
+
+        bool matches = registers.ProgramCounter == expected.ProgramCounter && registers.Index == expected.Index &&
+            registers.StackPointer == expected.StackPointer && registers.DelayTimer == expected.DelayTimer &&
+            registers.SoundTimer == expected.SoundTimer;
+
+        for (byte i = 0; i < Registers::MaximumStackCount; i++)
+        {
+            matches &= registers.Stack[i] == expected.Stack[i];
+        }
+
+        for (byte i = 0; i <= 0xF; i++)
+        {
+            matches &= registers.Variable[i] == expected.Variable[i];
+        }
+
+        const byte* memory = lockstep.GetMemory(instance);
+        for (word address = 0; address <= 0xFFF; address++)
+        {
+            matches &= memory[address] == emulator.ReadMemory(address);
+        }
+
+        std::uint64_t visible[Display::MaximumVisibleWords];
+        std::size_t count = emulator.GetDisplay().GetVisible(visible);
+
+        const std::uint64_t* display = lockstep.GetDisplay(instance);
+        matches &= count == Display::LowResHeight;
+        for (byte row = 0; row < Display::LowResHeight; row++)
+        {
+            matches &= display[row] == visible[row];
+        }
+
+        return matches;
+    }
+
+    //Runs a program on the lockstep emulator and on one Emulator per instance, with different keys held on each,
+    //and checks every instance after each batch of instructions
+    void CheckProgram(const char* name, const std::vector<byte>& program, std::size_t count, std::uint32_t keySeed)
+    {
+        LockstepEmulator lockstep(count, Seed);
+        lockstep.LoadProgram(program.data(), program.size());
+
+        std::vector<std::unique_ptr<Emulator>> emulators;
+        for (std::size_t instance = 0; instance < count; instance++)
+        {
+            emulators.emplace_back(new Emulator());
+            emulators.back()->SetSeed(Seed + (std::uint32_t)instance * 0x9E3779B9u);
+            emulators.back()->LoadProgram(program.data(), program.size());
+        }
+
+        std::mt19937 random(keySeed);
+
+        //Batches of every size, including ones past the budget the lockstep emulator splits calls into
+        const std::uint64_t batches[] = { 1, 3, 7, 100, 1000, 20000, 1, 2, 500, 40000, 5 };
+
+        for (std::uint64_t cycles : batches)
+        {
+            for (std::size_t instance = 0; instance < count; instance++)
+            {
+                //Most instances hold nothing, so waiting for a key splits the lanes
+                word keys = (random() % 3 == 0) ? (word)random() : 0;
+
+                lockstep.SetKeys(instance, keys);
+                emulators[instance]->SetKeys(keys);
+            }
+
+            lockstep.Execute(cycles);
+            lockstep.TickTimers();
+
+            for (std::size_t instance = 0; instance < count; instance++)
+            {
+                emulators[instance]->Execute(cycles);
+                emulators[instance]->TickTimers();
+            }
+
+            for (std::size_t instance = 0; instance < count; instance++)
+            {
+                if (!Matches(lockstep, instance, *emulators[instance]))
+                {
+                    Check(false, std::string(name) + ": instance " + std::to_string(instance) + " matches Emulator after " +
+                        std::to_string(cycles) + " instructions");
+                    return;
+                }
+            }
+        }
+    }
+
+    //A random program of instructions the modern profile knows, jumping and calling only into itself.
+    //Stores through I land in the program too, so instances end up running code of their own
+    std::vector<byte> RandomProgram(std::uint32_t seed, word length)
+    {
+        std::mt19937 random(seed);
+
+        auto pick = [&](std::uint32_t count) { return (word)(random() % count); };
+        auto target = [&]() { return (word)(0x200 + pick(length) * 2); };
+
+        std::vector<byte> program;
+
+        for (word i = 0; i < length; i++)
+        {
+            word x = pick(0x10) << 8;
+            word y = pick(0x10) << 4;
+            word opcode = 0;
+
+            switch (pick(18))
+            {
+                case 0: opcode = pick(4) == 0 ? 0x00E0 : 0x00EE; break;
+                case 1: opcode = 0x1000 | target(); break;
+                case 2: opcode = 0x2000 | target(); break;
+                case 3: opcode = 0x3000 | x | pick(4); break;
+                case 4: opcode = 0x4000 | x | pick(4); break;
+                case 5: opcode = 0x5000 | x | y; break;
+                case 6: opcode = 0x6000 | x | pick(0x100); break;
+                case 7: opcode = 0x7000 | x | pick(0x100); break;
+                case 8:
+                {
+                    static const word operations[] = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE };
+                    opcode = 0x8000 | x | y | operations[pick(9)];
+                    break;
+                }
+                case 9: opcode = 0x9000 | x | y; break;
+                case 10: opcode = 0xA000 | target(); break;
+                case 11: opcode = 0xB000 | target(); break;
+                case 12: opcode = 0xC000 | x | pick(0x100); break;
+                case 13: opcode = 0xD000 | x | y | pick(0x10); break;
+                case 14: opcode = 0xE000 | x | (pick(2) ? 0x9E : 0xA1); break;
+                default:
+                {
+                    static const word operations[] = { 0x07, 0x0A, 0x15, 0x18, 0x1E, 0x29, 0x33, 0x55, 0x65 };
+                    opcode = 0xF000 | x | operations[pick(9)];
+                    break;
+                }
+            }
+
+            program.push_back((byte)(opcode >> 8));
+            program.push_back((byte)opcode);
+        }
+
+        return program;
+    }
+}
+
+int main(int, char**)
+{
+    //Every instance runs the same instructions until some hold a key down: LD V0, 5; SKP V0; JP 0x202;
+    //then a loop counting in V1 and drawing
+    CheckProgram("key wait", { 0x60, 0x05, 0xE0, 0x9E, 0x12, 0x02, 0x71, 0x01, 0xA0, 0x50, 0xD1, 0x15, 0x12, 0x06 }, 37, 1);
+
+    //A coin flip decides whether V1 is counted: RND V0, 1; SE V0, 0; ADD V1, 1; ADD V2, 1; JP 0x200
+    CheckProgram("random branch", { 0xC0, 0x01, 0x30, 0x00, 0x71, 0x01, 0x72, 0x01, 0x12, 0x00 }, 70, 2);
+
+    //Waiting for a key, then counting the keys into a subroutine: LD V3, K; CALL 0x206; JP 0x200; ADD V4, V3 (8434); RET
+    CheckProgram("key wait instruction", { 0xF3, 0x0A, 0x22, 0x06, 0x12, 0x00, 0x84, 0x34, 0x00, 0xEE }, 33, 3);
+
+    for (std::uint32_t seed = 0; seed < 40; seed++)
+    {
+        CheckProgram(("random program " + std::to_string(seed)).c_str(), RandomProgram(seed, 48), 1 + seed * 7 % 67, seed);
+    }
+
+    if (failures == 0)
+    {
+        std::cout << "All lockstep tests passed" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "Emulator/Emulator.h"
+
+namespace
+{
+    using namespace CHIP8;
+
+    //Where SaveState() writes the stack pointer, right after the program counter, the index and the stack
+    constexpr std::size_t StackPointerOffset = 4 + 2 + Memory::Size + Display::PlaneCount * Display::Height * 2 * 8 + 1 + 1 +
+        2 + 2 + Registers::MaximumStackCount * 2;
+
+    int failures = 0;
+
+    void Check(bool condition, const char* message)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    //A state with the given stack pointer is loaded only if it points into the stack, and leaves the emulator alone otherwise
+    void CheckStackPointer(sbyte stackPointer, bool valid)
+    {
+        //CALL 0x204, then spin at 0x204
+        const byte program[] = { 0x22, 0x04, 0x00, 0x00, 0x12, 0x04 };
+
+        Emulator emulator;
+        emulator.LoadProgram(program, sizeof(program));
+        emulator.Execute(8);
+
+        std::vector<byte> before = emulator.SaveState();
+        std::vector<byte> state = before;
+        state[StackPointerOffset] = (byte)stackPointer;
+
+        bool loaded = emulator.LoadState(state.data(), state.size());
+
+        if (valid)
+        {
+            Check(loaded, "a state with the stack pointer inside the stack is loaded");
+            Check(emulator.GetRegisters().StackPointer == stackPointer, "the stack pointer of a loaded state is restored");
+        }
+        else
+        {
+            Check(!loaded, "a state with the stack pointer outside the stack is rejected");
+            Check(emulator.SaveState() == before, "a rejected state changes nothing");
+        }
+    }
+}
+
+int main(int, char**)
+{
+    Check(CHIP8::Emulator().SaveState()[StackPointerOffset] == 0xFF, "the stack pointer of a fresh emulator is saved as -1");
+
+    CheckStackPointer(-1, true);
+    CheckStackPointer(0, true);
+    CheckStackPointer(CHIP8::Registers::MaximumStackCount - 1, true);
+
+    CheckStackPointer(CHIP8::Registers::MaximumStackCount, false);
+    CheckStackPointer(127, false);
+    CheckStackPointer(-2, false);
+    CheckStackPointer(-128, false);
+
+    if (failures == 0)
+    {
+        std::cout << "All state tests passed" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
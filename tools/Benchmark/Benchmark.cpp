@@ -0,0 +1,463 @@
+#include "Benchmark/Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "Emulator/JitCache.h"
+#include "Emulator/Profiler.h"
+#include "Emulator/Scheduler.h"
+#include "Lockstep/LockstepEmulator.h"
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Handler loops start here, after the prologue
+        constexpr word ProgramStart = 0x200;
+
+        //CALL addr in a handler loop calls a RET here, and the stores write to the data after it
+        constexpr word SubroutineAddress = 0x300;
+        constexpr word DataAddress = 0x320;
+
+        //The number of times a handler loop repeats its instruction, so each iteration is about one block
+        constexpr word HandlerRepeats = 60;
+
+        //CALL addr in a mix calls a RET here, and the stores write to the data here
+        constexpr word MixSubroutineAddress = 0xF00;
+        constexpr word MixDataAddress = 0x700;
+
+        //The number of instructions picked for a mix
+        constexpr word MixLength = 0x100;
+
+        //Makes a ROM out of instructions at their addresses, gaps are left at zero
+        std::shared_ptr<const Rom> Assemble(const std::vector<std::pair<word, word>>& instructions)
+        {
+            std::vector<byte> data;
+
+            for (const auto& instruction : instructions)
+            {
+                std::size_t offset = instruction.first - ProgramStart;
+                data.resize(std::max(data.size(), offset + 2), 0x00);
+
+                data[offset] = (byte)(instruction.second >> 8);
+                data[offset + 1] = (byte)instruction.second;
+            }
+
+            return Rom::Copy(data.data(), data.size());
+        }
+
+        //A small xorshift, so the mixes are the same on every host
+        std::uint32_t NextRandom(std::uint32_t& state)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return state;
+        }
+
+        const char* ModeName(ExecutionMode mode)
+        {
+            return mode == ExecutionMode::Jit ? "jit" : "interpreter";
+        }
+    }
+
+    void BenchmarkSuite::AddRom(const std::string& name, std::shared_ptr<const Rom> rom)
+    {
+        Program program;
+        program.Name = name;
+        program.Image = std::move(rom);
+
+        m_Roms.push_back(program);
+    }
+
+    BenchmarkSuite::Program BenchmarkSuite::HandlerProgram(const std::string& name, std::vector<word> prologue, word body, bool chained, word keys)
+    {
+        std::vector<std::pair<word, word>> instructions;
+        word address = ProgramStart;
+
+        for (word instruction : prologue)
+        {
+            instructions.emplace_back(address, instruction);
+            address += 2;
+        }
+
+        word loop = address;
+
+        //Chained jumps continue at the instruction right after themselves
+        for (word i = 0; i < HandlerRepeats; i++)
+        {
+            instructions.emplace_back(address, chained ? (word)(body | (address + 2)) : body);
+            address += 2;
+        }
+
+        //ADD VE, 1; JP loop
+        instructions.emplace_back(address, 0x7E01);
+        instructions.emplace_back(address + 2, (word)(0x1000 | loop));
+
+        //RET
+        instructions.emplace_back(SubroutineAddress, 0x00EE);
+
+        Program program;
+        program.Name = name;
+        program.Image = Assemble(instructions);
+        program.Keys = keys;
+
+        return program;
+    }
+
+    BenchmarkSuite::Program BenchmarkSuite::MixProgram(const std::string& name, const std::vector<word>& mix, std::uint32_t seed)
+    {
+        std::vector<std::pair<word, word>> instructions;
+        word address = ProgramStart;
+
+        std::uint32_t state = seed;
+        bool previousSkips = false;
+
+        for (word i = 0; i < MixLength; i++)
+        {
+            word instruction = mix[NextRandom(state) % mix.size()];
+
+            //VE counts the iterations and VF is the flag, so neither is picked
+            word x = (word)(NextRandom(state) % 0xE) << 8;
+            word y = (word)(NextRandom(state) % 0xE) << 4;
+            word nn = NextRandom(state) & 0xFF;
+
+            switch (instruction >> 12)
+            {
+                case 0x3:
+                case 0x4:
+                case 0x6:
+                case 0x7:
+                case 0xC: instruction |= x | nn; break;
+
+                case 0x5:
+                case 0x8:
+                case 0x9:
+                case 0xD: instruction |= x | y; break;
+
+                case 0xE:
+                case 0xF: instruction |= x; break;
+
+                default: break;
+            }
+
+            //Stores always go to the data, never into the code. A skip right before them could skip setting I, which
+            //leaves it wherever the instructions before put it, so I is set twice and the second one is never skipped
+            bool stores = (instruction & 0xF0FF) == 0xF033 || (instruction & 0xF0FF) == 0xF055;
+
+            if (stores)
+            {
+                for (byte copy = 0; copy < (previousSkips ? 2 : 1); copy++)
+                {
+                    instructions.emplace_back(address, (word)(0xA000 | MixDataAddress));
+                    address += 2;
+                }
+            }
+
+            instructions.emplace_back(address, instruction);
+            address += 2;
+
+            //SE, SNE, SKP and SKNP
+            byte opcode = instruction >> 12;
+            previousSkips = opcode == 0x3 || opcode == 0x4 || opcode == 0x5 || opcode == 0x9 || opcode == 0xE;
+        }
+
+        //ADD VE, 1; JP 0x200
+        instructions.emplace_back(address, 0x7E01);
+        instructions.emplace_back(address + 2, (word)(0x1000 | ProgramStart));
+
+        //RET
+        instructions.emplace_back(MixSubroutineAddress, 0x00EE);
+
+        Program program;
+        program.Name = name;
+        program.Image = Assemble(instructions);
+
+        return program;
+    }
+
+    void BenchmarkSuite::Run()
+    {
+        const word data = 0xA000 | DataAddress;
+        const word call = 0x2000 | SubroutineAddress;
+
+        std::vector<Program> handlers =
+        {
+            HandlerProgram("00E0", {}, 0x00E0),
+            HandlerProgram("1NNN", {}, 0x1000, true),
+            HandlerProgram("2NNN+00EE", {}, call),
+            HandlerProgram("3XNN", {}, 0x3001),
+            HandlerProgram("4XNN", {}, 0x4000),
+            HandlerProgram("5XY0", { 0x6101 }, 0x5010),
+            HandlerProgram("6XNN", {}, 0x6A55),
+            HandlerProgram("7XNN", {}, 0x7A03),
+            HandlerProgram("8XY0", { 0x6A37, 0x6B5C }, 0x8AB0),
+            HandlerProgram("8XY1", { 0x6A37, 0x6B5C }, 0x8AB1),
+            HandlerProgram("8XY2", { 0x6A37, 0x6B5C }, 0x8AB2),
+            HandlerProgram("8XY3", { 0x6A37, 0x6B5C }, 0x8AB3),
+            HandlerProgram("8XY4", { 0x6A37, 0x6B5C }, 0x8AB4),
+            HandlerProgram("8XY5", { 0x6A37, 0x6B5C }, 0x8AB5),
+            HandlerProgram("8XY6", { 0x6A37, 0x6B5C }, 0x8AB6),
+            HandlerProgram("8XY7", { 0x6A37, 0x6B5C }, 0x8AB7),
+            HandlerProgram("8XYE", { 0x6A37, 0x6B5C }, 0x8ABE),
+            HandlerProgram("9XY0", {}, 0x9000),
+            HandlerProgram("ANNN", {}, data),
+            HandlerProgram("BNNN", { 0x6000 }, 0xB000, true),
+            HandlerProgram("CXNN", {}, 0xC0FF),
+            HandlerProgram("DXY1", { 0xA000, 0x6005, 0x610A }, 0xD011),
+            HandlerProgram("DXY8", { 0xA000, 0x6005, 0x610A }, 0xD018),
+            HandlerProgram("DXYF", { 0xA000, 0x6005, 0x610A }, 0xD01F),
+            HandlerProgram("DXYF wrapped", { 0xA000, 0x603C, 0x611C }, 0xD01F),
+            HandlerProgram("EX9E", {}, 0xE09E),
+            HandlerProgram("EXA1", {}, 0xE0A1, false, 0x0001),
+            HandlerProgram("FX07", {}, 0xF007),
+            HandlerProgram("FX0A", {}, 0xF00A, false, 0x0001),
+            HandlerProgram("FX15", {}, 0xF015),
+            HandlerProgram("FX18", {}, 0xF018),
+            HandlerProgram("FX1E", { 0x6001 }, 0xF01E),
+            HandlerProgram("FX29", { 0x6007 }, 0xF029),
+            HandlerProgram("FX33", { data, 0x60FF }, 0xF033),
+            //The longest loads and stores stop before VE, loading it would make the loop idle
+            HandlerProgram("F055", { data }, 0xF055),
+            HandlerProgram("FD55", { data }, 0xFD55),
+            HandlerProgram("F065", { data }, 0xF065),
+            HandlerProgram("FD65", { data }, 0xFD65)
+        };
+
+        std::vector<Program> programs =
+        {
+            MixProgram("alu_mix", { 0x6000, 0x7000, 0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005, 0x8006, 0x8007, 0x800E, 0xF01E, 0xA000 | MixDataAddress }, 1),
+            MixProgram("branch_mix", { 0x3000, 0x4000, 0x5000, 0x9000, 0x2000 | MixSubroutineAddress, 0x6000, 0x7000, 0x8004 }, 2),
+            MixProgram("game_mix", { 0xD005, 0xD008, 0xF029, 0xC000, 0xF007, 0xF015, 0xE0A1, 0xE09E, 0x6000, 0x7000, 0x8004, 0xF033, 0xF065, 0x3000 }, 3)
+        };
+
+        programs.insert(programs.end(), m_Roms.begin(), m_Roms.end());
+
+        //Every instance doing the same work, every other one held in a key wait loop, and every instance
+        //taking a branch on a coin flip of its own
+        Program lockstepUniform;
+        lockstepUniform.Name = "lockstep_uniform";
+        lockstepUniform.Image = Assemble({ { 0x200, 0x7001 }, { 0x202, 0x8014 }, { 0x204, 0x8125 }, { 0x206, 0x6A07 },
+            { 0x208, 0xF01E }, { 0x20A, 0x8236 }, { 0x20C, 0xA000 | DataAddress }, { 0x20E, 0x1200 } });
+
+        Program lockstepKeyWait;
+        lockstepKeyWait.Name = "lockstep_key_wait";
+        lockstepKeyWait.Image = Assemble({ { 0x200, 0x6005 }, { 0x202, 0xE09E }, { 0x204, 0x1202 }, { 0x206, 0x7101 },
+            { 0x208, 0x8214 }, { 0x20A, 0x8325 }, { 0x20C, 0xF11E }, { 0x20E, 0x1206 } });
+        lockstepKeyWait.Keys = 1 << 0x5;
+
+        Program lockstepRandomBranch;
+        lockstepRandomBranch.Name = "lockstep_random_branch";
+        lockstepRandomBranch.Image = Assemble({ { 0x200, 0xC001 }, { 0x202, 0x3000 }, { 0x204, 0x7101 }, { 0x206, 0x7201 },
+            { 0x208, 0x8314 }, { 0x20A, 0x1200 } });
+
+        std::vector<Program> lockstepPrograms = { lockstepUniform, lockstepKeyWait, lockstepRandomBranch };
+
+        std::vector<ExecutionMode> modes = { ExecutionMode::Interpreter };
+
+        if (JitCache::IsSupported() && !ExecutionProfiler::Enabled)
+        {
+            modes.push_back(ExecutionMode::Jit);
+        }
+
+        m_Results.clear();
+
+        for (ExecutionMode mode : modes)
+        {
+            for (const Program& program : handlers)
+            {
+                if (Matches(program.Name))
+                {
+                    RunHandler(program, mode);
+                }
+            }
+
+            for (const Program& program : programs)
+            {
+                if (Matches(program.Name))
+                {
+                    RunThroughput(program, mode);
+                }
+            }
+
+            for (const Program& program : lockstepPrograms)
+            {
+                if (Matches(program.Name))
+                {
+                    RunInstances(program, mode);
+                }
+            }
+        }
+
+        for (const Program& program : lockstepPrograms)
+        {
+            if (Matches(program.Name))
+            {
+                RunLockstep(program);
+            }
+        }
+    }
+
+    void BenchmarkSuite::RunHandler(const Program& program, ExecutionMode mode)
+    {
+        Emulator emulator(program.Image);
+        emulator.SetExecutionMode(mode);
+        emulator.SetKeys(program.Keys);
+
+        //Warm up, so every block is translated and compiled before the clock starts
+        emulator.Execute(100000);
+
+        BenchmarkResult result;
+        result.Name = program.Name;
+        result.Kind = "handler";
+        result.Mode = mode;
+        result.Instructions = m_Instructions;
+
+        for (unsigned repetition = 0; repetition < m_Repetitions; repetition++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            emulator.Execute(m_Instructions);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            result.Seconds = repetition == 0 ? seconds : std::min(result.Seconds, seconds);
+        }
+
+        m_Results.push_back(result);
+    }
+
+    void BenchmarkSuite::RunThroughput(const Program& program, ExecutionMode mode)
+    {
+        BenchmarkResult result;
+        result.Name = program.Name;
+        result.Kind = "throughput";
+        result.Mode = mode;
+        result.Frames = m_Frames;
+
+        for (unsigned repetition = 0; repetition < m_Repetitions; repetition++)
+        {
+            //Every repetition starts from the beginning of the program, so they all execute the same instructions
+            Emulator emulator(program.Image);
+            emulator.SetExecutionMode(mode);
+            emulator.SetKeys(program.Keys);
+
+            Scheduler scheduler(emulator);
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (std::uint64_t frame = 0; frame < m_Frames; frame++)
+            {
+                scheduler.RunFrame();
+            }
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            result.Instructions = scheduler.GetCycles();
+            result.Seconds = repetition == 0 ? seconds : std::min(result.Seconds, seconds);
+        }
+
+        m_Results.push_back(result);
+    }
+
+    void BenchmarkSuite::RunLockstep(const Program& program)
+    {
+        std::uint64_t cycles = std::max<std::uint64_t>(m_Instructions / m_Instances, 1);
+
+        BenchmarkResult result;
+        result.Name = program.Name;
+        result.Kind = "lockstep";
+        result.Instructions = cycles * m_Instances;
+
+        for (unsigned repetition = 0; repetition < m_Repetitions; repetition++)
+        {
+            LockstepEmulator lockstep(m_Instances);
+            lockstep.LoadProgram(program.Image->GetData(), program.Image->GetSize());
+
+            for (std::size_t instance = 1; instance < m_Instances; instance += 2)
+            {
+                lockstep.SetKeys(instance, program.Keys);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            lockstep.Execute(cycles);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            result.Seconds = repetition == 0 ? seconds : std::min(result.Seconds, seconds);
+        }
+
+        m_Results.push_back(result);
+    }
+
+    void BenchmarkSuite::RunInstances(const Program& program, ExecutionMode mode)
+    {
+        std::uint64_t cycles = std::max<std::uint64_t>(m_Instructions / m_Instances, 1);
+
+        BenchmarkResult result;
+        result.Name = program.Name;
+        result.Kind = "instances";
+        result.Mode = mode;
+        result.Instructions = cycles * m_Instances;
+
+        for (unsigned repetition = 0; repetition < m_Repetitions; repetition++)
+        {
+            //The same instances as RunLockstep(), each with a random sequence of its own
+            std::vector<std::unique_ptr<Emulator>> emulators;
+
+            for (std::size_t instance = 0; instance < m_Instances; instance++)
+            {
+                emulators.emplace_back(new Emulator(program.Image));
+                emulators.back()->SetExecutionMode(mode);
+                emulators.back()->SetSeed((std::uint32_t)instance);
+                emulators.back()->SetKeys(instance % 2 ? program.Keys : 0);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (std::unique_ptr<Emulator>& emulator : emulators)
+            {
+                emulator->Execute(cycles);
+            }
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            result.Seconds = repetition == 0 ? seconds : std::min(result.Seconds, seconds);
+        }
+
+        m_Results.push_back(result);
+    }
+
+    void BenchmarkSuite::WriteJson(std::ostream& output) const
+    {
+#if defined(CHIP8_DISPATCH_THREADED)
+        const char* dispatch = "threaded";
+#else
+        const char* dispatch = "switch";
+#endif
+
+        output << "{\n";
+        output << "  \"build\": { \"dispatch\": \"" << dispatch << "\", \"jit\": " << (JitCache::IsSupported() ? "true" : "false");
+        output << ", \"profiler\": " << (ExecutionProfiler::Enabled ? "true" : "false") << " },\n";
+        output << "  \"benchmarks\": [";
+
+        for (std::size_t i = 0; i < m_Results.size(); i++)
+        {
+            const BenchmarkResult& result = m_Results[i];
+            double seconds = std::max(result.Seconds, 1e-9);
+
+            output << (i == 0 ? "\n" : ",\n");
+            output << "    { \"name\": \"" << result.Name << "\", \"kind\": \"" << result.Kind << "\", \"mode\": \"" << ModeName(result.Mode) << "\"";
+            output << ", \"instructions\": " << result.Instructions << ", \"seconds\": " << std::setprecision(6) << result.Seconds;
+            output << ", \"instructions_per_second\": " << std::fixed << std::setprecision(0) << result.Instructions / seconds;
+
+            if (result.Frames > 0)
+            {
+                output << ", \"frames\": " << result.Frames << ", \"frames_per_second\": " << result.Frames / seconds;
+            }
+
+            output << std::defaultfloat << " }";
+        }
+
+        output << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/RomCache.h"
+
+namespace CHIP8
+{
+    //The fastest of the repetitions of a single benchmark
+    struct BenchmarkResult
+    {
+        std::string Name;
+
+        //"handler" for the micro-benchmarks, "throughput" for whole programs, "lockstep" for many instances of a program
+        //on a LockstepEmulator and "instances" for the same instances as separate Emulators
+        std::string Kind;
+
+        ExecutionMode Mode = ExecutionMode::Interpreter;
+
+        std::uint64_t Instructions = 0;
+
+        //Timer ticks of emulated time, only counted by the throughput runs
+        std::uint64_t Frames = 0;
+
+        double Seconds = 0.0;
+    };
+
+    //Times every handler on its own, and whole programs at the default clock speed.
+    //
+    //A handler is timed with a loop that repeats its instruction, then counts up VE so the loop never looks idle.
+    //Whole programs run through a Scheduler, so the timers tick and idle loops are skipped like in a real run.
+    //Everything runs once per execution mode the host supports. The lockstep programs run on many instances at once,
+    //with every other instance holding keys down, and split the instructions between them.
+    class BenchmarkSuite
+    {
+    public:
+        //Only benchmarks whose name contains the filter run
+        void SetFilter(const std::string& filter) { m_Filter = filter; }
+
+        //The instructions each handler benchmark executes, and the frames each program runs for
+        void SetInstructions(std::uint64_t instructions) { m_Instructions = instructions; }
+        void SetFrames(std::uint64_t frames) { m_Frames = frames; }
+
+        //The instances each lockstep program runs on
+        void SetInstances(std::size_t instances) { m_Instances = instances > 0 ? instances : 1; }
+
+        //Every benchmark runs this many times, the fastest run is kept
+        void SetRepetitions(unsigned repetitions) { m_Repetitions = repetitions > 0 ? repetitions : 1; }
+
+        //Adds a ROM to the throughput runs
+        void AddRom(const std::string& name, std::shared_ptr<const Rom> rom);
+
+        void Run();
+
+        //Writes the build configuration and every result
+        void WriteJson(std::ostream& output) const;
+
+        const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+    private:
+        struct Program
+        {
+            std::string Name;
+            std::shared_ptr<const Rom> Image;
+
+            //The keys held down while it runs, only by every other instance for the lockstep programs
+            word Keys = 0;
+        };
+
+        std::string m_Filter;
+        std::uint64_t m_Instructions = 20000000;
+        std::uint64_t m_Frames = 200000;
+        std::size_t m_Instances = 256;
+        unsigned m_Repetitions = 3;
+
+        std::vector<Program> m_Roms;
+        std::vector<BenchmarkResult> m_Results;
+
+        //The loop timing a single handler, see BenchmarkSuite
+        static Program HandlerProgram(const std::string& name, std::vector<word> prologue, word body, bool chained = false, word keys = 0);
+
+        //A long run of instructions picked at random from a mix, looping back to the start
+        static Program MixProgram(const std::string& name, const std::vector<word>& mix, std::uint32_t seed);
+
+        void RunHandler(const Program& program, ExecutionMode mode);
+        void RunThroughput(const Program& program, ExecutionMode mode);
+        void RunLockstep(const Program& program);
+        void RunInstances(const Program& program, ExecutionMode mode);
+
+        bool Matches(const std::string& name) const { return name.find(m_Filter) != std::string::npos; }
+    };
+}
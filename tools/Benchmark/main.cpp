@@ -0,0 +1,80 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmark/Benchmark.h"
+#include "Emulator/RomCache.h"
+
+int main(int argc, char** argv)
+{
+    CHIP8::BenchmarkSuite suite;
+    std::string output;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            suite.SetFilter(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--instructions") == 0 && i + 1 < argc)
+        {
+            suite.SetInstructions(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            suite.SetFrames(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+        {
+            suite.SetInstances(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            suite.SetRepetitions((unsigned)std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--rom") == 0 && i + 1 < argc)
+        {
+            std::string path = argv[++i];
+            std::shared_ptr<const CHIP8::Rom> rom = CHIP8::RomCache::Global().Load(path);
+
+            if (!rom)
+            {
+                std::cerr << "Could not open " << path << std::endl;
+                return 1;
+            }
+
+            suite.AddRom(path.substr(path.find_last_of("/\\") + 1), rom);
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--filter text] [--instructions N] [--frames N] [--instances N] [--repetitions N] [--rom file]... [--output results.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    suite.Run();
+
+    if (output.empty())
+    {
+        suite.WriteJson(std::cout);
+        return 0;
+    }
+
+    std::ofstream file(output);
+
+    if (!file)
+    {
+        std::cerr << "Could not open " << output << std::endl;
+        return 1;
+    }
+
+    suite.WriteJson(file);
+
+    return 0;
+}
@@ -0,0 +1,346 @@
+#include "Recompiler/Recompiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Formats a number as hexadecimal with the given number of digits
+        std::string Hex(unsigned value, int digits)
+        {
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), "0x%0*X", digits, value);
+            return buffer;
+        }
+
+        //The name of the variable register X in the generated code
+        std::string V(byte x)
+        {
+            return "V[" + Hex(x, 1) + "]";
+        }
+
+        //The names of a profile and of its policy in the generated code
+        const char* GetProfileName(QuirkProfile profile)
+        {
+            switch (profile)
+            {
+                case QuirkProfile::CosmacVip: return "CosmacVip";
+                case QuirkProfile::SuperChip: return "SuperChip";
+                case QuirkProfile::XoChip: return "XoChip";
+                default: return "Modern";
+            }
+        }
+
+        //Whether or not the instruction skips the next one, which is the only one it can read
+        bool IsSkip(const Instruction& instruction)
+        {
+            switch (instruction.OpCode)
+            {
+                case 0x3:
+                case 0x4:
+                case 0x5:
+                case 0x9:
+                case 0xE: return true;
+
+                default: return false;
+            }
+        }
+
+        //The raw instruction an already decoded instruction was decoded from
+        word Encode(const Instruction& instruction)
+        {
+            return ((word)instruction.OpCode << 12) | instruction.NNN;
+        }
+    }
+
+    Recompiler::Recompiler(const byte* rom, std::size_t size, QuirkProfile quirks)
+        : m_Quirks(quirks)
+    {
+        //Programs start at 0x200, anything past the end of memory is cut off
+        size = std::min<std::size_t>(size, 0xE00);
+
+        byte image[Memory::Size] = { 0 };
+        memcpy(&image[0x200], rom, size);
+
+        m_Memory.Load(image);
+    }
+
+    void Recompiler::Analyze()
+    {
+        //Use the same block boundaries as the emulator, so every compiled block matches a translated one
+        std::unique_ptr<BlockCache> cache = std::make_unique<BlockCache>();
+
+        std::vector<bool> visited(0xFFF + 1, false);
+        std::vector<word> pending = { 0x200 };
+
+        m_Blocks.clear();
+
+        while (!pending.empty())
+        {
+            word address = pending.back() & 0xFFF;
+            pending.pop_back();
+
+            if (visited[address])
+            {
+                continue;
+            }
+
+            visited[address] = true;
+
+            Block& block = cache->Translate(m_Memory, address);
+            const Instruction* instructions = cache->Operations(block);
+            const Instruction& last = instructions[block.Length - 1];
+
+            AnalyzedBlock analyzed;
+            analyzed.Start = block.Start;
+            analyzed.End = block.End;
+            analyzed.Instructions.assign(instructions, instructions + block.Length);
+            m_Blocks.push_back(analyzed);
+
+            //Follow the successors known ahead of time
+            for (byte i = 0; i < block.Successors; i++)
+            {
+                pending.push_back(block.Next[i]->Start);
+            }
+
+            //CALL addr continues at NNN, and at the end of the block once the subroutine returns
+            if (last.OpCode == 0x2)
+            {
+                pending.push_back(last.NNN);
+                pending.push_back(block.End);
+            }
+
+            //LD VX, K repeats itself until a key is pressed
+            if (last.OpCode == 0xF && last.NN == 0x0A)
+            {
+                pending.push_back(block.End);
+            }
+
+            //XO-CHIP continues past the address of LD I, long, and a skip over it continues past both
+            if (QuirkFlags::Of(m_Quirks).XoChip && block.Successors == 0)
+            {
+                bool longLoad = last.OpCode == 0xF && last.X == 0x0 && last.NN == 0x00;
+                if (longLoad)
+                {
+                    pending.push_back(block.End + 2);
+                }
+
+                if (IsSkip(last))
+                {
+                    pending.push_back(block.End);
+                    pending.push_back(block.End + 4);
+                }
+            }
+
+            //RET and JP V0, addr are only known at runtime, so they are left to the interpreter
+        }
+
+        //The emulator looks blocks up by their start address
+        std::sort(m_Blocks.begin(), m_Blocks.end(), [](const AnalyzedBlock& a, const AnalyzedBlock& b)
+        {
+            return a.Start < b.Start;
+        });
+    }
+
+    void Recompiler::Generate(std::ostream& output, const std::string& name) const
+    {
+        output << "//Generated by CHIP8Recompiler, do not edit\n\n";
+        output << "#include \"Emulator/Emulator.h\"\n\n";
+        output << "namespace\n{\n";
+        output << "    using namespace CHIP8;\n\n";
+
+        //The instructions handed to the interpreter, blocks can overlap so each address is only written once
+        std::vector<bool> interpreted(0xFFF + 1, false);
+
+        for (const AnalyzedBlock& block : m_Blocks)
+        {
+            for (std::size_t i = 0; i < block.Instructions.size(); i++)
+            {
+                interpreted[(block.Start + 2 * i) & 0xFFF] = IsInterpreted(block.Instructions[i]);
+            }
+        }
+
+        for (word address = 0x000; address <= 0xFFF; address++)
+        {
+            if (!interpreted[address])
+            {
+                continue;
+            }
+
+            word raw = ((word)m_Memory.Read(address) << 8) | m_Memory.Read((address + 1) & 0xFFF);
+            output << "    constexpr Instruction Instruction" << Hex(address, 3).substr(2) << " = Decode(" << Hex(raw, 4) << ");\n";
+        }
+
+        output << "\n";
+
+        for (const AnalyzedBlock& block : m_Blocks)
+        {
+            std::string suffix = Hex(block.Start, 3).substr(2);
+
+            //The bytes this block was compiled from
+            output << "    const byte Code" << suffix << "[] =\n    {\n        ";
+
+            for (word address = block.Start; address < block.End; address++)
+            {
+                output << Hex(m_Memory.Read(address & 0xFFF), 2) << (address + 1 < block.End ? ", " : "\n");
+            }
+
+            output << "    };\n\n";
+
+            //Only name the parameters this block actually uses
+            bool usesContext = false;
+            bool usesMemory = false;
+
+            for (const Instruction& instruction : block.Instructions)
+            {
+                usesContext |= IsInterpreted(instruction);
+                usesMemory |= (instruction.OpCode == 0xF && instruction.NN == 0x65) || (IsSkip(instruction) && QuirkFlags::Of(m_Quirks).XoChip);
+            }
+
+            output << "    void Block" << suffix << "(void*" << (usesContext ? " context" : "") << ", Registers* registers, const byte* const*" << (usesMemory ? " memory" : "") << ")\n    {\n";
+            output << "        Registers& r = *registers;\n";
+            output << "        byte* V = r.Variable;\n";
+            output << "        (void)V;\n\n";
+
+            for (std::size_t i = 0; i < block.Instructions.size(); i++)
+            {
+                GenerateInstruction(output, block.Instructions[i], block.Start + (word)(2 * i));
+            }
+
+            output << "    }\n\n";
+        }
+
+        //Every block, sorted by their start address
+        output << "    const StaticBlock Blocks[] =\n    {\n";
+
+        for (const AnalyzedBlock& block : m_Blocks)
+        {
+            std::string suffix = Hex(block.Start, 3).substr(2);
+            output << "        { " << Hex(block.Start, 3) << ", " << block.Instructions.size() << ", Code" << suffix << ", &Block" << suffix << " },\n";
+        }
+
+        output << "    };\n}\n\n";
+        output << "extern const CHIP8::StaticProgram " << name << " = { Blocks, sizeof(Blocks) / sizeof(Blocks[0]), CHIP8::QuirkProfile::" << GetProfileName(m_Quirks) << " };\n";
+    }
+
+    bool Recompiler::IsInterpreted(const Instruction& instruction) const
+    {
+        QuirkFlags quirks = QuirkFlags::Of(m_Quirks);
+
+        switch (instruction.OpCode)
+        {
+            //CLS and RET, and the display instructions of SUPER-CHIP. SYS addr is ignored
+            case 0x0: return quirks.Extended || instruction.NNN == 0x0E0 || instruction.NNN == 0x0EE;
+
+            //The loads and stores of a range of registers of XO-CHIP
+            case 0x5: return quirks.XoChip && instruction.N != 0x0;
+
+            //ADD I, VX, LD F, VX and LD VX, [I] are compiled
+            case 0xF: return instruction.NN != 0x1E && instruction.NN != 0x29 && instruction.NN != 0x65;
+
+            //CALL addr, JP V0, addr, RND VX, byte, DRW VX, VY, nibble, SKP VX and SKNP VX
+            case 0x2:
+            case 0xB:
+            case 0xC:
+            case 0xD:
+            case 0xE: return true;
+
+            default: return false;
+        }
+    }
+
+    void Recompiler::GenerateInstruction(std::ostream& output, const Instruction& instruction, word address) const
+    {
+        std::string x = V(instruction.X);
+        std::string y = V(instruction.Y);
+        std::string nn = Hex(instruction.NN, 2);
+        std::string nnn = Hex(instruction.NNN, 3);
+
+        QuirkFlags quirks = QuirkFlags::Of(m_Quirks);
+
+        //The register shifted into VX
+        std::string shifted = quirks.ShiftReadsVY ? y : x;
+
+        //The logic operations clear VF on the original interpreter
+        std::string reset = quirks.LogicResetsVF ? " V[0xF] = 0;" : "";
+
+        //How far a skip jumps, XO-CHIP skips both words of F000 NNNN at once
+        std::string skipped = Hex(address + 2, 3);
+        std::string next = Hex(address + 3, 3);
+        std::string skip = !quirks.XoChip ? "2" :
+            "(memory[" + skipped + " >> 8][" + skipped + " & 0xFF] == 0xF0 && memory[" + next + " >> 8][" + next + " & 0xFF] == 0x00 ? 4 : 2)";
+
+        //Instructions touching the display, keypad, timers, stack or memory are interpreted with the same profile
+        std::string interpret = std::string("Emulator::Interpret<") + GetProfileName(m_Quirks) + "Quirks>(context, &Instruction" + Hex(address, 3).substr(2) + ");";
+
+        output << "        //" << Hex(address, 3) << ": " << Hex(Encode(instruction), 4).substr(2) << "\n        ";
+
+        if (IsInterpreted(instruction))
+        {
+            output << interpret << "\n";
+            return;
+        }
+
+        switch (instruction.OpCode)
+        {
+            case 0x0: output << "//SYS addr is ignored"; break;
+            case 0x1: output << "r.ProgramCounter = " << nnn << ";"; break;
+            case 0x3: output << "r.ProgramCounter += (" << x << " == " << nn << ") * " << skip << ";"; break;
+            case 0x4: output << "r.ProgramCounter += (" << x << " != " << nn << ") * " << skip << ";"; break;
+            case 0x5: output << "r.ProgramCounter += (" << x << " == " << y << ") * " << skip << ";"; break;
+            case 0x6: output << x << " = " << nn << ";"; break;
+            case 0x7: output << x << " += " << nn << ";"; break;
+
+            case 0x8:
+            {
+                switch (instruction.N)
+                {
+                    case 0x0: output << x << " = " << y << ";"; break;
+                    case 0x1: output << x << " |= " << y << ";" << reset; break;
+                    case 0x2: output << x << " &= " << y << ";" << reset; break;
+                    case 0x3: output << x << " ^= " << y << ";" << reset; break;
+                    case 0x4: output << "{ word result = " << x << " + " << y << "; V[0xF] = result > 0xFF; " << x << " = result & 0xFF; }"; break;
+                    case 0x5: output << "{ byte vx = " << x << ", vy = " << y << "; V[0xF] = vx > vy; " << x << " = vx - vy; }"; break;
+                    case 0x6: output << "{ byte value = " << shifted << "; V[0xF] = value & 0x01; " << x << " = value / 2; }"; break;
+                    case 0x7: output << "{ byte vx = " << x << ", vy = " << y << "; V[0xF] = vy > vx; " << x << " = vy - vx; }"; break;
+                    case 0xE: output << "{ byte value = " << shifted << "; V[0xF] = (value >> 7) & 0x01; " << x << " = value * 2; }"; break;
+                    default: output << "//No known opcodes"; break;
+                }
+
+                break;
+            }
+
+            case 0x9: output << "r.ProgramCounter += (" << x << " != " << y << ") * " << skip << ";"; break;
+            case 0xA: output << "r.Index = " << nnn << ";"; break;
+
+            case 0xF:
+            {
+                switch (instruction.NN)
+                {
+                    case 0x1E: output << "r.Index += " << x << ";"; break;
+                    case 0x29: output << "r.Index = 5 * " << x << ";"; break;
+                    case 0x65:
+                    {
+                        output << "for (int i = 0; i <= " << Hex(instruction.X, 1) << "; i++) { word a = (r.Index + i) & " << Hex(quirks.AddressMask, 3) << "; V[i] = memory[a >> 8][a & 0xFF]; }";
+
+                        //The original interpreter left I past the last register
+                        if (quirks.LoadStoreAdvancesIndex)
+                        {
+                            output << " r.Index += " << (instruction.X + 1) << ";";
+                        }
+
+                        break;
+                    }
+                }
+
+                break;
+            }
+
+        }
+
+        output << "\n";
+    }
+}
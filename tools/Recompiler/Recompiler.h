@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/BlockCache.h"
+#include "Emulator/Instruction.h"
+#include "Emulator/Memory.h"
+#include "Emulator/Quirks.h"
+
+namespace CHIP8
+{
+    //Translates a ROM into C++ source, with one function per block reachable from 0x200
+    class Recompiler
+    {
+    public:
+        //The generated code behaves like the given quirk profile, and only runs on emulators using it
+        Recompiler(const byte* rom, std::size_t size, QuirkProfile quirks = QuirkProfile::Modern);
+
+        //Walks the control flow from 0x200 and collects every reachable block
+        void Analyze();
+
+        //Writes the source of every reachable block, exported as a StaticProgram with the given name
+        void Generate(std::ostream& output, const std::string& name) const;
+
+        //The number of reachable blocks found by Analyze()
+        std::size_t BlockCount() const { return m_Blocks.size(); }
+
+    private:
+        struct AnalyzedBlock
+        {
+            word Start = 0x0000;
+            word End = 0x0000;
+
+            std::vector<Instruction> Instructions;
+        };
+
+        //The memory image the ROM will run in, with the ROM loaded at 0x200
+        Memory m_Memory;
+
+        std::vector<AnalyzedBlock> m_Blocks;
+
+        QuirkProfile m_Quirks = QuirkProfile::Modern;
+
+        //Whether or not an instruction is handed to the interpreter instead of being compiled
+        bool IsInterpreted(const Instruction& instruction) const;
+
+        //Writes the C++ statements for a single instruction
+        void GenerateInstruction(std::ostream& output, const Instruction& instruction, word address) const;
+    };
+}
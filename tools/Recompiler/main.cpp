@@ -0,0 +1,68 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Recompiler/Recompiler.h"
+
+int main(int argc, char** argv)
+{
+    //The optional name, then the options
+    const char* name = "RecompiledProgram";
+    CHIP8::QuirkProfile quirks = CHIP8::QuirkProfile::Modern;
+    bool valid = argc >= 3;
+
+    for (int i = 3; valid && i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "--quirks" && i + 1 < argc)
+        {
+            valid = CHIP8::ParseQuirkProfile(argv[++i], quirks);
+        }
+        else if (i == 3 && argument.rfind("--", 0) != 0)
+        {
+            name = argv[i];
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Usage: " << argv[0] << " <rom> <output.cpp> [name] [--quirks modern|vip|schip|xochip]" << std::endl;
+        return 1;
+    }
+
+    //Read the whole ROM
+    std::ifstream input(argv[1], std::ios::binary);
+
+    if (!input)
+    {
+        std::cerr << "Could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<CHIP8::byte> rom((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    //Find every reachable block and write them out
+    CHIP8::Recompiler recompiler(rom.data(), rom.size(), quirks);
+    recompiler.Analyze();
+
+    std::ofstream output(argv[2]);
+
+    if (!output)
+    {
+        std::cerr << "Could not open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    recompiler.Generate(output, name);
+
+    std::cout << "Recompiled " << recompiler.BlockCount() << " blocks from " << argv[1] << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,450 @@
+#include "Regression/CorpusRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "Emulator/JitCache.h"
+#include "Emulator/RomCache.h"
+
+namespace CHIP8
+{
+    namespace
+    {
+        //Paths in a corpus are relative to the corpus itself
+        std::string Resolve(const std::string& directory, const std::string& path)
+        {
+            bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+
+            return absolute ? path : directory + path;
+        }
+
+        bool IsNumber(const std::string& text)
+        {
+            return !text.empty() && text.size() <= 19 && text.find_first_not_of("0123456789") == std::string::npos;
+        }
+
+        const char* ModeName(ExecutionMode mode)
+        {
+            return mode == ExecutionMode::Jit ? "jit" : "interpreter";
+        }
+    }
+
+    bool GoldenFile::Load(const std::string& path, std::string& error)
+    {
+        std::ifstream file(path);
+
+        if (!file)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        Hashes.clear();
+        Seconds.clear();
+
+        std::uint64_t frames = 0;
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string first;
+
+            //Skip empty lines and comments
+            if (!(tokens >> first) || first[0] == '#')
+            {
+                continue;
+            }
+
+            if (first == "frames")
+            {
+                tokens >> frames;
+            }
+            else if (first == "seconds")
+            {
+                std::string mode;
+                double seconds = 0.0;
+
+                tokens >> mode >> seconds;
+                Seconds[mode] = seconds;
+            }
+            else if (first.size() == 16 && first.find_first_not_of("0123456789abcdef") == std::string::npos)
+            {
+                Hashes.push_back(std::stoull(first, nullptr, 16));
+            }
+            else
+            {
+                tokens.setstate(std::ios::failbit);
+            }
+
+            if (tokens.fail())
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": expected frames <count>, seconds <mode> <seconds> or a hash";
+                return false;
+            }
+        }
+
+        if (frames != Hashes.size())
+        {
+            error = path + ": expected " + std::to_string(frames) + " hashes, found " + std::to_string(Hashes.size());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool GoldenFile::Save(const std::string& path) const
+    {
+        std::ofstream file(path);
+
+        if (!file)
+        {
+            return false;
+        }
+
+        file << "# Written by CHIP8Regression --update\n";
+        file << "frames " << Hashes.size() << '\n';
+
+        for (const auto& seconds : Seconds)
+        {
+            file << "seconds " << seconds.first << ' ' << std::setprecision(9) << seconds.second << '\n';
+        }
+
+        for (std::uint64_t hash : Hashes)
+        {
+            file << std::hex << std::setw(16) << std::setfill('0') << hash << '\n';
+        }
+
+        return (bool)file;
+    }
+
+    bool CorpusRunner::LoadCorpus(const std::string& path, std::string& error)
+    {
+        std::ifstream corpus(path);
+
+        if (!corpus)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::size_t separator = path.find_last_of("/\\");
+        std::string directory = separator == std::string::npos ? "" : path.substr(0, separator + 1);
+
+        m_Entries.clear();
+
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(corpus, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string rom;
+
+            //Skip empty lines and comments
+            if (!(tokens >> rom) || rom[0] == '#')
+            {
+                continue;
+            }
+
+            CorpusEntry entry;
+            entry.Rom = Resolve(directory, rom);
+            entry.Golden = entry.Rom + ".golden";
+
+            std::string setting;
+
+            while (tokens >> setting)
+            {
+                std::size_t equals = setting.find('=');
+                std::string key = setting.substr(0, equals);
+                std::string value = equals == std::string::npos ? "" : setting.substr(equals + 1);
+
+                if (key == "frames" && IsNumber(value))
+                {
+                    entry.Frames = std::stoull(value);
+                }
+                else if (key == "clock" && IsNumber(value) && value.size() <= 9 && std::stoul(value) > 0)
+                {
+                    entry.ClockSpeed = (std::uint32_t)std::stoul(value);
+                }
+                else if (key == "seed" && IsNumber(value))
+                {
+                    entry.Seed = (std::uint32_t)std::stoul(value);
+                }
+                else if (key == "quirks")
+                {
+                    if (!ParseQuirkProfile(value.c_str(), entry.Quirks))
+                    {
+                        error = path + ":" + std::to_string(lineNumber) + ": unknown quirk profile " + value;
+                        return false;
+                    }
+                }
+                else if (key == "input" && !value.empty())
+                {
+                    entry.Input = Resolve(directory, value);
+                }
+                else if (key == "golden" && !value.empty())
+                {
+                    entry.Golden = Resolve(directory, value);
+                }
+                else
+                {
+                    error = path + ":" + std::to_string(lineNumber) + ": invalid setting " + setting;
+                    return false;
+                }
+            }
+
+            if (entry.Frames == 0)
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": missing frames";
+                return false;
+            }
+
+            m_Entries.push_back(entry);
+        }
+
+        return true;
+    }
+
+    bool CorpusRunner::Run(std::ostream& report)
+    {
+        //Golden times are kept per mode, hosts without a JIT fall back to the interpreter
+        const std::string mode = ModeName(m_Mode == ExecutionMode::Jit && JitCache::IsSupported() ? m_Mode : ExecutionMode::Interpreter);
+        bool passed = true;
+
+        for (const CorpusEntry& entry : m_Entries)
+        {
+            std::shared_ptr<const Rom> rom = RomCache::Global().Load(entry.Rom);
+            std::vector<FrameKeyEvent> events;
+            std::string error;
+
+            if (!rom)
+            {
+                error = "Could not open " + entry.Rom;
+            }
+            else if (!entry.Input.empty())
+            {
+                LoadInput(entry.Input, events, error);
+            }
+
+            GoldenFile golden;
+
+            //Updating keeps the golden times of the other modes, if there are any
+            if (error.empty() && !golden.Load(entry.Golden, error) && m_Update)
+            {
+                golden = GoldenFile();
+                error.clear();
+            }
+
+            if (!error.empty())
+            {
+                report << "FAIL " << entry.Rom << ": " << error << std::endl;
+                passed = false;
+                continue;
+            }
+
+            //Every repetition has to draw the same frames, anything else is a bug on its own
+            std::vector<std::uint64_t> hashes;
+            std::vector<std::uint64_t> repeated;
+            double seconds = RunEntry(entry, rom, events, hashes);
+
+            for (unsigned repetition = 1; repetition < m_Repetitions && error.empty(); repetition++)
+            {
+                seconds = std::min(seconds, RunEntry(entry, rom, events, repeated));
+
+                if (repeated != hashes)
+                {
+                    error = "not deterministic, repetitions drew different frames";
+                }
+            }
+
+            if (error.empty() && m_Update)
+            {
+                golden.Hashes = hashes;
+                golden.Seconds[mode] = seconds;
+
+                if (!golden.Save(entry.Golden))
+                {
+                    error = "Could not write " + entry.Golden;
+                }
+            }
+            else if (error.empty())
+            {
+                auto difference = std::mismatch(hashes.begin(), hashes.end(), golden.Hashes.begin(), golden.Hashes.end());
+
+                if (difference.first != hashes.end() || difference.second != golden.Hashes.end())
+                {
+                    std::size_t frame = difference.first - hashes.begin();
+
+                    error = frame < std::min(hashes.size(), golden.Hashes.size()) ?
+                        "display differs from the golden one at frame " + std::to_string(frame) :
+                        "ran " + std::to_string(hashes.size()) + " frames, the golden file has " + std::to_string(golden.Hashes.size());
+                }
+            }
+
+            std::ostringstream timing;
+            timing << std::fixed << std::setprecision(3) << seconds * 1000.0 << " ms";
+
+            //Correct so far, now check it didn't get slower than the golden run
+            auto baseline = golden.Seconds.find(mode);
+
+            if (error.empty() && !m_Update && baseline != golden.Seconds.end() && baseline->second > 0.0)
+            {
+                double slowdown = seconds / baseline->second;
+                timing << std::setprecision(2) << ", " << slowdown << "x the golden time";
+
+                if (m_MaximumSlowdown > 0.0 && slowdown > m_MaximumSlowdown)
+                {
+                    std::ostringstream message;
+                    message << "slower than the golden run by more than " << m_MaximumSlowdown << "x";
+                    error = message.str();
+                }
+            }
+
+            if (error.empty())
+            {
+                report << (m_Update ? "UPDATED " : "PASS ") << entry.Rom << " (" << mode << ", " << entry.Frames << " frames, " << timing.str() << ")" << std::endl;
+            }
+            else
+            {
+                report << "FAIL " << entry.Rom << " (" << mode << ", " << timing.str() << "): " << error << std::endl;
+                passed = false;
+            }
+        }
+
+        return passed;
+    }
+
+    double CorpusRunner::RunEntry(const CorpusEntry& entry, const std::shared_ptr<const Rom>& rom, const std::vector<FrameKeyEvent>& events, std::vector<std::uint64_t>& hashes) const
+    {
+        hashes.assign(entry.Frames, 0);
+
+        Emulator emulator(rom);
+        emulator.SetQuirks(entry.Quirks);
+        emulator.SetExecutionMode(m_Mode);
+        emulator.SetSeed(entry.Seed);
+
+        //Never paced to the wall clock, so the frames only depend on the entry
+        Scheduler scheduler(emulator, entry.ClockSpeed);
+        std::size_t nextEvent = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::uint64_t frame = 0; frame < entry.Frames; frame++)
+        {
+            //Apply every key event that is due
+            for (; nextEvent < events.size() && events[nextEvent].Frame <= frame; nextEvent++)
+            {
+                emulator.SetKey(events[nextEvent].Key, events[nextEvent].Pressed);
+            }
+
+            scheduler.RunFrame();
+
+            std::uint64_t display[Display::MaximumVisibleWords];
+            hashes[frame] = HashDisplay(display, emulator.GetDisplay().GetVisible(display));
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool CorpusRunner::LoadInput(const std::string& path, std::vector<FrameKeyEvent>& events, std::string& error)
+    {
+        std::ifstream script(path);
+
+        if (!script)
+        {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(script, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string first;
+
+            //Skip empty lines and comments
+            if (!(tokens >> first) || first[0] == '#')
+            {
+                continue;
+            }
+
+            FrameKeyEvent event;
+            unsigned int key = 0;
+            std::string state;
+
+            tokens >> std::hex >> key >> state;
+
+            if (!IsNumber(first) || tokens.fail() || key > 0xF || (state != "down" && state != "up"))
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": expected <frame> <key> <down|up>";
+                return false;
+            }
+
+            event.Frame = std::stoull(first);
+            event.Key = (byte)key;
+            event.Pressed = state == "down";
+
+            events.push_back(event);
+        }
+
+        //Events at the same frame keep the order they were written in
+        std::stable_sort(events.begin(), events.end(), [](const FrameKeyEvent& a, const FrameKeyEvent& b)
+        {
+            return a.Frame < b.Frame;
+        });
+
+        return true;
+    }
+
+    std::uint64_t CorpusRunner::HashDisplay(const std::uint64_t* display, std::size_t words)
+    {
+        constexpr std::size_t Lanes = 8;
+        constexpr std::uint32_t Prime1 = 0x9E3779B1u;
+        constexpr std::uint32_t Prime2 = 0x85EBCA77u;
+
+        std::uint32_t lanes[Lanes];
+
+        for (std::size_t lane = 0; lane < Lanes; lane++)
+        {
+            lanes[lane] = Prime1 + (std::uint32_t)lane * Prime2;
+        }
+
+        //Every lane takes every eighth half of a word, high half first so the hash doesn't depend on the host.
+        //Each step is a multiply, a rotate and a multiply, all of which have a vector instruction.
+        //The display always has a multiple of 32 words
+        for (std::size_t row = 0; row < words; row += Lanes / 2)
+        {
+            for (std::size_t lane = 0; lane < Lanes; lane++)
+            {
+                std::uint64_t bits = display[row + lane / 2];
+                std::uint32_t half = (std::uint32_t)(lane % 2 == 0 ? bits >> 32 : bits);
+
+                std::uint32_t mixed = lanes[lane] + half * Prime2;
+                lanes[lane] = ((mixed << 13) | (mixed >> 19)) * Prime1;
+            }
+        }
+
+        //Fold the lanes together in order, then spread the last lane over every bit
+        std::uint64_t hash = 0;
+
+        for (std::size_t lane = 0; lane < Lanes; lane++)
+        {
+            hash = (hash ^ lanes[lane]) * 0x9E3779B97F4A7C15ull;
+        }
+
+        return hash ^ (hash >> 29);
+    }
+}
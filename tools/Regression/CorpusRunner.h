@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Base.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/Scheduler.h"
+
+namespace CHIP8
+{
+    //A key pressed or released by an input script, right before the given frame runs
+    struct FrameKeyEvent
+    {
+        std::uint64_t Frame = 0;
+        byte Key = 0x0;
+        bool Pressed = false;
+    };
+
+    //A ROM of the corpus, played for a number of frames with an optional input script
+    struct CorpusEntry
+    {
+        std::string Rom;
+        std::string Input;
+        std::string Golden;
+
+        std::uint64_t Frames = 0;
+        std::uint32_t Seed = 0;
+        std::uint32_t ClockSpeed = Scheduler::DefaultClockSpeed;
+        QuirkProfile Quirks = QuirkProfile::Modern;
+    };
+
+    //What an entry is expected to do, written by a known good build
+    struct GoldenFile
+    {
+        //The display hash after every frame
+        std::vector<std::uint64_t> Hashes;
+
+        //The fastest run of the entry, per execution mode
+        std::map<std::string, double> Seconds;
+
+        bool Load(const std::string& path, std::string& error);
+        bool Save(const std::string& path) const;
+    };
+
+    //Plays every ROM of a corpus headless and compares the display after every frame, and the time it took,
+    //against the golden files of a known good build.
+    //
+    //A corpus is a manifest like the one of the BatchRunner, but counted in frames, relative paths start at the manifest:
+    //    roms/pong.ch8 frames=600 input=inputs/pong.txt seed=7 clock=1000 quirks=vip golden=golden/pong.txt
+    //The golden file defaults to the ROM's path with .golden appended.
+    //Every line of an input script is the frame, the key in hexadecimal and whether it goes down or up:
+    //    120 4 down
+    //Lines starting with # are comments in both.
+    class CorpusRunner
+    {
+    public:
+        //Reads the entries of a corpus, returns false and describes the problem if it can't be used
+        bool LoadCorpus(const std::string& path, std::string& error);
+
+        void SetExecutionMode(ExecutionMode mode) { m_Mode = mode; }
+
+        //Every entry runs this many times, the fastest run is compared against the golden one
+        void SetRepetitions(unsigned repetitions) { m_Repetitions = repetitions > 0 ? repetitions : 1; }
+
+        //A run slower than the golden one by more than this factor fails, 0 never fails on time
+        void SetMaximumSlowdown(double slowdown) { m_MaximumSlowdown = slowdown; }
+
+        //Writes the golden files from this run instead of comparing against them.
+        //Golden times of the other execution modes are kept
+        void SetUpdate(bool update) { m_Update = update; }
+
+        //Runs every entry and reports one line per entry, returns true if they all passed
+        bool Run(std::ostream& report);
+
+        std::size_t GetEntryCount() const { return m_Entries.size(); }
+
+        //A hash of the visible words of the display that's the same on every host. Words are mixed as 32-bit halves
+        //in eight independent lanes, so the compiler can keep the lanes in vector registers
+        static std::uint64_t HashDisplay(const std::uint64_t* display, std::size_t words);
+
+    private:
+        std::vector<CorpusEntry> m_Entries;
+
+        ExecutionMode m_Mode = ExecutionMode::Interpreter;
+        unsigned m_Repetitions = 3;
+        double m_MaximumSlowdown = 1.5;
+        bool m_Update = false;
+
+        //Runs an entry, fills in the hash of every frame and returns the seconds the frames took
+        double RunEntry(const CorpusEntry& entry, const std::shared_ptr<const Rom>& rom, const std::vector<FrameKeyEvent>& events, std::vector<std::uint64_t>& hashes) const;
+
+        //Reads the key events of an input script, sorted by the frame they happen at
+        static bool LoadInput(const std::string& path, std::vector<FrameKeyEvent>& events, std::string& error);
+    };
+}
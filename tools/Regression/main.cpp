@@ -0,0 +1,52 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Regression/CorpusRunner.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        std::cerr << "Usage: " << argv[0] << " <corpus> [--jit] [--repetitions N] [--max-slowdown factor] [--update]" << std::endl;
+        return 1;
+    }
+
+    CHIP8::CorpusRunner runner;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--jit") == 0)
+        {
+            runner.SetExecutionMode(CHIP8::ExecutionMode::Jit);
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            runner.SetRepetitions((unsigned)std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--max-slowdown") == 0 && i + 1 < argc)
+        {
+            runner.SetMaximumSlowdown(std::strtod(argv[++i], nullptr));
+        }
+        else if (strcmp(argv[i], "--update") == 0)
+        {
+            runner.SetUpdate(true);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::string error;
+
+    if (!runner.LoadCorpus(argv[1], error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    return runner.Run(std::cout) ? 0 : 1;
+}